@@ -0,0 +1,118 @@
+/**
+ * @brief Scaling microbenchmark for the per-SNR error/bit accumulators.
+ *
+ * Compares the two layouts simulate_mod has used:
+ *  - shared: one std::vector<std::atomic<uint64_t>> per counter, updated by
+ *    every thread with fetch_add (adjacent points share cache lines);
+ *  - padded: one cache-line sized PointCounters per (thread, point), written
+ *    with plain load + store and reduced once at the end.
+ *
+ * Each update is preceded by a small amount of dummy work standing in for a
+ * (very short) simulation block. Thread counts sweep 1, 2, 4, ..., 64.
+ *
+ * Usage: qam_counter_bench [updates_per_thread] [work_per_update]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kPoints = 41;  ///< SNR points, as in a -20..20 dB sweep
+
+struct alignas(64) PointCounters {
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> bits{0};
+
+    void add(uint64_t e, uint64_t b) {
+        errors.store(errors.load(std::memory_order_relaxed) + e,
+                     std::memory_order_relaxed);
+        bits.store(bits.load(std::memory_order_relaxed) + b,
+                   std::memory_order_relaxed);
+    }
+};
+
+/// @brief Dummy block work; returns a fake error count
+uint64_t work(uint64_t& state, unsigned amount) {
+    for (unsigned k = 0; k < amount; ++k) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+    }
+    return state & 0xFF;
+}
+
+template <typename Body>
+double run_threads(int num_threads, size_t updates, Body body) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] { body(t, updates); });
+    }
+    for (auto& th : threads) th.join();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return static_cast<double>(updates) * num_threads / elapsed.count() / 1e6;
+}
+
+double bench_shared(int num_threads, size_t updates, unsigned amount) {
+    std::vector<std::atomic<uint64_t>> errors(kPoints);
+    std::vector<std::atomic<uint64_t>> bits(kPoints);
+    return run_threads(num_threads, updates, [&](int t, size_t n) {
+        uint64_t state = 0x9E3779B97F4A7C15ull + t;
+        for (size_t k = 0; k < n; ++k) {
+            const size_t i = k % kPoints;
+            errors[i] += work(state, amount);
+            bits[i] += 64;
+        }
+    });
+}
+
+double bench_padded(int num_threads, size_t updates, unsigned amount) {
+    std::vector<std::vector<PointCounters>> counters(num_threads);
+    for (auto& c : counters) c = std::vector<PointCounters>(kPoints);
+    double rate = run_threads(num_threads, updates, [&](int t, size_t n) {
+        uint64_t state = 0x9E3779B97F4A7C15ull + t;
+        auto& own = counters[t];
+        for (size_t k = 0; k < n; ++k) {
+            own[k % kPoints].add(work(state, amount), 64);
+        }
+    });
+    uint64_t total_bits = 0;
+    for (const auto& c : counters)
+        for (const auto& p : c) total_bits += p.bits.load();
+    if (total_bits != static_cast<uint64_t>(num_threads) * updates * 64) {
+        std::cerr << "padded counters lost updates\n";
+        std::exit(EXIT_FAILURE);
+    }
+    return rate;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t updates = argc > 1 ? std::stoull(argv[1]) : 2000000;
+    const unsigned amount =
+        argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : 4;
+
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency()
+              << ", updates/thread: " << updates
+              << ", work/update: " << amount << "\n";
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "shared Mupd/s"
+              << std::setw(16) << "padded Mupd/s" << std::setw(10)
+              << "speedup" << "\n";
+    for (int threads = 1; threads <= 64; threads *= 2) {
+        double shared = bench_shared(threads, updates, amount);
+        double padded = bench_padded(threads, updates, amount);
+        std::cout << std::fixed << std::setprecision(1) << std::setw(8)
+                  << threads << std::setw(16) << shared << std::setw(16)
+                  << padded << std::setw(9) << padded / shared << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,228 @@
+/**
+ * @brief Google Benchmark suite for every stage of the simulation chain.
+ *
+ * Each benchmark is parameterized over the constellation order M (4 to
+ * 4096) and the block size in symbols, and reports symbols/s (items) and the
+ * bytes/s of the samples or bits it streams. The chain benchmarks run the
+ * staged and fused compositions of the same stages. Set QAM_SIMD to compare
+ * instruction sets.
+ *
+ * Usage: qam_bench [--benchmark_filter=<regex>] [other benchmark flags]
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "qam_simulator/demodulator_qam.hpp"
+#include "qam_simulator/modulator_qam.hpp"
+#include "qam_simulator/noise.hpp"
+#include "qam_simulator/packed_bits.hpp"
+#include "qam_simulator/pipeline.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+
+namespace {
+
+constexpr double kSnrDb = 10.0;
+constexpr size_t kTile = 1024;  ///< Fused chain tile, as in the pipeline
+
+/**
+ * @brief Random bits, their symbols and a noisy copy for one (M, size).
+ */
+struct Fixture {
+    Fixture(int levels, size_t symbols)
+        : mod(levels),
+          demod(levels),
+          bits(symbols * mod.getBitsPerSymbol()),
+          clean(symbols),
+          noisy(symbols),
+          decided(bits.size()),
+          rng(1) {
+        generateRandomBits(bits, rng);
+        mod.modulate(bits, clean.view());
+        std::copy_n(clean.re(), symbols, noisy.re());
+        std::copy_n(clean.im(), symbols, noisy.im());
+        NoiseAdder(kSnrDb, mod.getAveragePower(), NoiseEngineKind::Ziggurat,
+                   2)
+            .addNoise(noisy.view());
+        demod.demodulate_hard(noisy, decided);
+    }
+
+    size_t symbols() const { return clean.size(); }
+
+    ModulatorQAM mod;
+    DemodulatorQAM demod;
+    PackedBits bits;
+    SampleBuffer clean;
+    SampleBuffer noisy;
+    PackedBits decided;
+    std::mt19937 rng;
+};
+
+constexpr size_t kSampleBytes = 2 * sizeof(float);
+
+void set_rates(benchmark::State& state, size_t symbols, size_t bytes) {
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(symbols));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(bytes));
+}
+
+void BM_Modulate(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    SampleBuffer out(f.symbols());
+    for (auto _ : state) {
+        f.mod.modulate(f.bits, out.view());
+        benchmark::DoNotOptimize(out.re());
+        benchmark::ClobberMemory();
+    }
+    set_rates(state, f.symbols(), f.symbols() * kSampleBytes);
+}
+
+template <NoiseEngineKind Kind>
+void BM_AddNoise(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    NoiseAdder noise(kSnrDb, f.mod.getAveragePower(), Kind, 3);
+    SampleBuffer work(f.symbols());
+    std::copy_n(f.clean.re(), f.symbols(), work.re());
+    std::copy_n(f.clean.im(), f.symbols(), work.im());
+    for (auto _ : state) {
+        noise.addNoise(work.view());
+        benchmark::DoNotOptimize(work.re());
+        benchmark::ClobberMemory();
+    }
+    set_rates(state, f.symbols(), f.symbols() * kSampleBytes);
+}
+
+void BM_DemodulateHard(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    PackedBits out(f.bits.size());
+    for (auto _ : state) {
+        f.demod.demodulate_hard(f.noisy, out);
+        benchmark::DoNotOptimize(out.words().data());
+        benchmark::ClobberMemory();
+    }
+    set_rates(state, f.symbols(), f.symbols() * kSampleBytes);
+}
+
+void BM_DemodulateSoftMaxLog(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    std::vector<float> llrs(f.bits.size());
+    const float n0 = static_cast<float>(f.mod.getAveragePower() /
+                                        std::pow(10.0, kSnrDb / 10.0));
+    for (auto _ : state) {
+        f.demod.demodulate_soft(f.noisy, n0, llrs);
+        benchmark::DoNotOptimize(llrs.data());
+        benchmark::ClobberMemory();
+    }
+    set_rates(state, f.symbols(), f.symbols() * kSampleBytes);
+}
+
+/// @brief Legacy source: one uniform_int_distribution draw on mt19937 per bit
+void BM_GenerateRandomBits(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    for (auto _ : state) {
+        generateRandomBits(f.bits, f.rng);
+        benchmark::DoNotOptimize(f.bits.words().data());
+        benchmark::ClobberMemory();
+    }
+    set_rates(state, f.symbols(), f.bits.words().size_bytes());
+}
+
+/// @brief Packed words straight from xoshiro256** output
+void BM_GenerateRandomBitsXoshiro(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    Xoshiro256 rng(5);
+    for (auto _ : state) {
+        generateRandomBits(f.bits, rng);
+        benchmark::DoNotOptimize(f.bits.words().data());
+        benchmark::ClobberMemory();
+    }
+    set_rates(state, f.symbols(), f.bits.words().size_bytes());
+}
+
+void BM_CountBitErrors(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(count_bit_errors(f.bits, f.decided));
+    }
+    set_rates(state, f.symbols(), 2 * f.bits.words().size_bytes());
+}
+
+/// @brief Modulate, noise, demodulate and count, one full pass per stage
+void BM_StagedChain(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    NoiseAdder noise(kSnrDb, f.mod.getAveragePower(),
+                     NoiseEngineKind::Ziggurat, 4);
+    SampleBuffer s(f.symbols());
+    PackedBits r(f.bits.size());
+    for (auto _ : state) {
+        f.mod.modulate(f.bits, s.view());
+        noise.addNoise(s.view());
+        f.demod.demodulate_hard(s, r);
+        benchmark::DoNotOptimize(count_bit_errors(f.bits, r));
+    }
+    set_rates(state, f.symbols(), f.symbols() * kSampleBytes);
+}
+
+/// @brief The same stages, one L1-sized tile at a time
+void BM_FusedChain(benchmark::State& state) {
+    Fixture f(static_cast<int>(state.range(0)),
+              static_cast<size_t>(state.range(1)));
+    NoiseAdder noise(kSnrDb, f.mod.getAveragePower(),
+                     NoiseEngineKind::Ziggurat, 4);
+    const int bps = f.mod.getBitsPerSymbol();
+    const size_t tile = std::min(kTile, f.symbols());
+    SampleBuffer s(tile);
+    PackedBits r(tile * bps);
+    const auto words = std::span<const uint64_t>(f.bits.words());
+    for (auto _ : state) {
+        uint64_t errors = 0;
+        for (size_t i = 0; i < f.symbols(); i += tile) {
+            const size_t n = std::min(tile, f.symbols() - i);
+            SampleView t = s.view().subview(0, n);
+            f.mod.modulate(f.bits, i, t);
+            noise.addNoise(t);
+            f.demod.demodulate_hard(t, r);
+            errors += count_bit_errors(
+                r.words(), words.subspan(i * bps / PackedBits::kWordBits));
+        }
+        benchmark::DoNotOptimize(errors);
+    }
+    set_rates(state, f.symbols(), f.symbols() * kSampleBytes);
+}
+
+void orders_and_sizes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"M", "symbols"});
+    b->ArgsProduct(
+        {{4, 16, 64, 256, 1024, 4096}, {1 << 10, 1 << 14, 1 << 18}});
+}
+
+}  // namespace
+
+BENCHMARK(BM_Modulate)->Apply(orders_and_sizes);
+BENCHMARK(BM_AddNoise<NoiseEngineKind::StdNormal>)->Apply(orders_and_sizes);
+BENCHMARK(BM_AddNoise<NoiseEngineKind::Ziggurat>)->Apply(orders_and_sizes);
+BENCHMARK(BM_AddNoise<NoiseEngineKind::Pooled>)->Apply(orders_and_sizes);
+BENCHMARK(BM_DemodulateHard)->Apply(orders_and_sizes);
+BENCHMARK(BM_DemodulateSoftMaxLog)->Apply(orders_and_sizes);
+BENCHMARK(BM_GenerateRandomBits)->Apply(orders_and_sizes);
+BENCHMARK(BM_GenerateRandomBitsXoshiro)->Apply(orders_and_sizes);
+BENCHMARK(BM_CountBitErrors)->Apply(orders_and_sizes);
+BENCHMARK(BM_StagedChain)->Apply(orders_and_sizes);
+BENCHMARK(BM_FusedChain)->Apply(orders_and_sizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @file
+ * @brief CPU topology discovery and worker pinning (--affinity=).
+ *
+ * Nodes are read from /sys/devices/system/node and limited to the CPUs the
+ * process may run on, so cgroup and taskset restrictions are honoured.
+ * Hosts without NUMA information are presented as one node. Linux only;
+ * elsewhere pinning is a no-op.
+ */
+
+/**
+ * @brief How pool workers are bound to CPUs.
+ */
+enum class AffinityMode {
+    None,  ///< Leave placement to the OS scheduler
+    Core,  ///< One CPU per worker, nodes filled round-robin
+    Node   ///< All CPUs of one node per worker, nodes round-robin
+};
+
+/**
+ * @brief Parse "none", "core" or "node".
+ *
+ * @throws std::invalid_argument for other names
+ */
+AffinityMode parseAffinityMode(std::string_view name);
+
+/// @brief Name of @p mode, as accepted by parseAffinityMode()
+const char* affinityModeName(AffinityMode mode) noexcept;
+
+/**
+ * @brief Usable CPUs grouped by NUMA node.
+ */
+struct CpuTopology {
+    std::vector<std::vector<int>> nodes;  ///< CPU ids of each non-empty node
+
+    /// @brief The topology of this host as seen by this process
+    static const CpuTopology& host();
+};
+
+/**
+ * @brief CPUs and node of each worker of a pool under one AffinityMode.
+ *
+ * Worker w is placed on node w % nodes, so consecutive workers alternate
+ * between sockets and any worker count balances across them; Core mode
+ * then takes the (w / nodes)-th CPU of that node, wrapping if the node has
+ * fewer CPUs than workers.
+ */
+class AffinityPlan {
+   public:
+    AffinityPlan() = default;
+    AffinityPlan(AffinityMode mode, const CpuTopology& topology);
+
+    /**
+     * @brief Pin the calling thread as worker @p worker.
+     *
+     * @return false if pinning is disabled or the OS refused it
+     */
+    bool pin(int worker) const;
+
+    /// @brief NUMA node of worker @p worker (0 when not pinned)
+    size_t nodeOf(int worker) const;
+
+    AffinityMode mode() const noexcept { return mode_; }
+
+    /// @brief One-line description for the run header
+    std::string describe() const;
+
+   private:
+    AffinityMode mode_ = AffinityMode::None;
+    std::vector<std::vector<int>> nodes_;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/**
+ * @brief Minimal allocator returning storage aligned to a fixed boundary.
+ *
+ * The default 64-byte alignment matches a cache line and one AVX-512
+ * register, so buffers handed to the SIMD kernels never split a vector load
+ * across two lines.
+ *
+ * @tparam T Element type
+ * @tparam Alignment Alignment in bytes (power of two)
+ */
+template <typename T, std::size_t Alignment = 64>
+struct AlignedAllocator {
+    using value_type = T;
+
+    static constexpr std::align_val_t alignment{Alignment};
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), alignment));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, alignment);
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Number of heap allocations made by the calling thread so far.
+ *
+ * Linking src/utils/alloc_counter.cpp replaces the global operator new
+ * family with versions that bump a thread-local counter before forwarding
+ * to malloc. Comparing two readings around a region of code tells whether
+ * it touched the general-purpose heap.
+ *
+ * @return Allocations (operator new / new[] calls) on this thread.
+ */
+uint64_t thread_allocation_count() noexcept;
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Per-thread bump allocator for the buffers of one block.
+ *
+ * allocate() hands out 64-byte aligned runs of one slab by bumping an
+ * offset, and reset() rewinds it, so a worker that carves the same buffers
+ * block after block never frees or reallocates them. Storage is
+ * uninitialized and only trivially copyable types may live in it.
+ *
+ * Running past the slab opens an extra slab instead of moving the live
+ * buffers. The next reset() replaces all slabs by a single one of the
+ * peak size, so the arena settles into one slab; reserve() lets the owner
+ * reach that state before the first block.
+ *
+ * Not thread safe: each pool worker owns its own arena.
+ */
+class Arena {
+   public:
+    /// @brief Alignment of every allocation (a cache line, one AVX-512 load)
+    static constexpr size_t kAlignment = 64;
+
+    Arena() = default;
+    explicit Arena(size_t bytes) { reserve(bytes); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) noexcept = default;
+    Arena& operator=(Arena&&) noexcept = default;
+
+    /**
+     * @brief Carve @p n uninitialized elements of T.
+     *
+     * The run stays valid until the next reset().
+     */
+    template <typename T>
+    std::span<T> allocate(size_t n) {
+        static_assert(std::is_trivially_copyable_v<T> &&
+                          alignof(T) <= kAlignment,
+                      "Arena: only trivially copyable types fit");
+        const size_t bytes = roundUp(n * sizeof(T));
+        if (slabs_.empty() || offset_ + bytes > slabs_.back().size) {
+            const size_t last = slabs_.empty() ? 0 : slabs_.back().size;
+            slabs_.push_back(Slab::make(std::max(2 * last, bytes)));
+            offset_ = 0;
+        }
+        std::byte* p = slabs_.back().data.get() + offset_;
+        offset_ += bytes;
+        used_ += bytes;
+        peak_ = std::max(peak_, used_);
+        return {reinterpret_cast<T*>(p), n};
+    }
+
+    /**
+     * @brief Release every allocation at once.
+     *
+     * Keeps the storage, coalesced into one slab if allocate() had to
+     * open more than one since the last reset.
+     */
+    void reset() {
+        if (slabs_.size() > 1) {
+            slabs_.clear();
+            slabs_.push_back(Slab::make(peak_));
+        }
+        offset_ = 0;
+        used_ = 0;
+    }
+
+    /**
+     * @brief Make sure a reset arena holds @p bytes without growing.
+     *
+     * @p bytes should include the padding of each allocation, see
+     * bytesFor(). Only acts while nothing is allocated.
+     */
+    void reserve(size_t bytes) {
+        if (used_ != 0 || bytes <= capacity()) return;
+        slabs_.clear();
+        slabs_.push_back(Slab::make(bytes));
+        offset_ = 0;
+        peak_ = std::max(peak_, bytes);
+    }
+
+    /// @brief Bytes handed out since the last reset, padding included
+    size_t used() const noexcept { return used_; }
+
+    /// @brief Bytes of all slabs
+    size_t capacity() const noexcept {
+        size_t total = 0;
+        for (const Slab& slab : slabs_) total += slab.size;
+        return total;
+    }
+
+    /// @brief Bytes allocate<T>(n) takes from the arena
+    template <typename T>
+    static constexpr size_t bytesFor(size_t n) {
+        return roundUp(n * sizeof(T));
+    }
+
+   private:
+    struct AlignedDelete {
+        void operator()(std::byte* p) const noexcept {
+            ::operator delete[](p, std::align_val_t{kAlignment});
+        }
+    };
+
+    struct Slab {
+        std::unique_ptr<std::byte[], AlignedDelete> data;
+        size_t size = 0;
+
+        static Slab make(size_t bytes) {
+            bytes = std::max(bytes, kAlignment);
+            return {std::unique_ptr<std::byte[], AlignedDelete>(
+                        static_cast<std::byte*>(::operator new[](
+                            bytes, std::align_val_t{kAlignment}))),
+                    bytes};
+        }
+    };
+
+    static constexpr size_t roundUp(size_t bytes) {
+        return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    std::vector<Slab> slabs_;
+    size_t offset_ = 0;  ///< Bump offset into the last slab
+    size_t used_ = 0;
+    size_t peak_ = 0;  ///< Largest used() seen, the size reset() coalesces to
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Saved state of one SNR point: the blocks counted so far.
+ *
+ * Blocks are counted in index order, so blocks 0 .. blocks - 1 are in the
+ * totals and the point resumes at block @c blocks. With keyed RNG streams
+ * the block index is the whole stream position.
+ */
+struct PointCheckpoint {
+    uint64_t blocks = 0;
+    uint64_t errors = 0;
+    uint64_t bits = 0;
+    double weighted = 0.0;     ///< Importance-sampling sums (0 otherwise)
+    double weighted_sq = 0.0;
+};
+
+/**
+ * @brief Saved state of one modulation order.
+ */
+struct ModulationCheckpoint {
+    int levels = 0;  ///< Constellation order M
+    std::vector<PointCheckpoint> points;
+};
+
+/**
+ * @brief Snapshot of a sweep, written periodically with --checkpoint= and
+ * read back by --resume=.
+ */
+struct Checkpoint {
+    uint64_t seed = 0;    ///< Master seed of the run
+    uint64_t config = 0;  ///< Fingerprint of the options the counts depend on
+    std::vector<ModulationCheckpoint> modulations;
+};
+
+/**
+ * @brief Write @p checkpoint to @p path.
+ *
+ * The file is written next to @p path and renamed over it, so a run killed
+ * mid-write leaves the previous checkpoint intact. The format is a small
+ * native-endian binary file (magic, version, then the fields above).
+ *
+ * @return false if the file could not be written
+ */
+bool writeCheckpoint(const std::string& path, const Checkpoint& checkpoint);
+
+/**
+ * @brief Read a checkpoint written by writeCheckpoint().
+ *
+ * @return std::nullopt if @p path does not exist
+ * @throws std::runtime_error if the file is not a valid checkpoint
+ */
+std::optional<Checkpoint> readCheckpoint(const std::string& path);
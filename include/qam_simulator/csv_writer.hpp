@@ -1,6 +1,7 @@
 #pragma once
 
 #include <fstream>
+#include <iomanip>
 #include <string>
 
 /**
@@ -39,6 +40,20 @@ class CsvWriter {
      */
     void write_row(double snr, double ber);
 
+    /**
+     * @brief Writes a row of any streamable values, comma-separated.
+     *
+     * Floating-point values use the same fixed 12-digit format as
+     * write_row().
+     */
+    template <typename... Values>
+    void write_values(const Values&... values) {
+        ofs_ << std::fixed << std::setprecision(12);
+        const char* sep = "";
+        ((ofs_ << sep << values, sep = ","), ...);
+        ofs_ << "\n";
+    }
+
    private:
     std::ofstream ofs_;  ///< Output file stream for writing CSV data.
 };
\ No newline at end of file
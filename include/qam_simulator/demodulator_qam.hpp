@@ -1,38 +1,282 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <limits>
 #include <span>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "qam_simulator/packed_bits.hpp"
+#include "qam_simulator/qam_traits.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+#include "qam_simulator/simd.hpp"
+
+namespace qam_detail {
+
+/// @brief Symbols sliced per SIMD call
+inline constexpr size_t kSliceTile = 256;
+
+/**
+ * @brief Per-axis hard decisions into a packed stream, fixed bit count.
+ */
+template <int Bps>
+void slicePacked(ConstSampleView symbols, const simd::AxisSlicer& slicer,
+                 PackedBitWriter& writer) {
+    std::array<int32_t, kSliceTile> idx;
+    for (size_t i = 0; i < symbols.size(); i += kSliceTile) {
+        size_t n = std::min(kSliceTile, symbols.size() - i);
+        simd::slice(symbols.re + i, symbols.im + i, n, slicer, idx.data());
+        for (size_t k = 0; k < n; ++k) {
+            writer.put(static_cast<uint64_t>(idx[k]), Bps);
+        }
+    }
+}
+
+/**
+ * @brief Per-axis hard decisions, one bit per byte, fixed bit count.
+ *
+ * Symbol indices are their own bit labels, so the bits are plain shifts.
+ */
+template <int Bps>
+void sliceBytes(ConstSampleView symbols, const simd::AxisSlicer& slicer,
+                uint8_t* out) {
+    std::array<int32_t, kSliceTile> idx;
+    for (size_t i = 0; i < symbols.size(); i += kSliceTile) {
+        size_t n = std::min(kSliceTile, symbols.size() - i);
+        simd::slice(symbols.re + i, symbols.im + i, n, slicer, idx.data());
+        for (size_t k = 0; k < n; ++k, out += Bps) {
+            for (int j = 0; j < Bps; ++j) {
+                out[j] = static_cast<uint8_t>((idx[k] >> (Bps - 1 - j)) & 1);
+            }
+        }
+    }
+}
+
+/// @brief Validate that @p nbits output bits match @p num_symbols symbols
+inline void checkHardSize(size_t nbits, size_t num_symbols, int bps) {
+    if (nbits != num_symbols * bps) {
+        throw std::invalid_argument(
+            "DemodulatorQAM: output size must equal symbols * "
+            "BitsPerSymbol");
+    }
+}
+
+}  // namespace qam_detail
+
+/**
+ * @brief Hard-decision QAM demodulator for an order fixed at compile time.
+ *
+ * Slices per axis against the constexpr grid of QamTraits<M>; the bit
+ * count is a constant, so the bit write-out loops unroll fully.
+ * DemodulatorQAM dispatches to the same kernels at runtime.
+ *
+ * @tparam M Number of constellation points (4^k, 4 to 4096)
+ */
+template <int M>
+class FixedDemodulatorQAM {
+   public:
+    using Traits = QamTraits<M>;
+    using value_type = typename Traits::value_type;
+
+    /**
+     * @brief Hard decisions into a packed bitstream.
+     *
+     * @param bits Output stream; resized to symbols.size() * BitsPerSymbol
+     * bits if needed (no allocation when the size already matches)
+     */
+    static void demodulate_hard(ConstSampleView symbols, PackedBits& bits) {
+        const size_t nbits = symbols.size() * Traits::kBitsPerSymbol;
+        if (bits.size() != nbits) bits.resize(nbits);
+        demodulate_hard(symbols, bits.view());
+    }
+
+    /**
+     * @brief Hard decisions into caller-provided packed storage.
+     *
+     * @throws std::invalid_argument if the output size does not match
+     */
+    static void demodulate_hard(ConstSampleView symbols, PackedBitsView bits) {
+        qam_detail::checkHardSize(bits.size(), symbols.size(),
+                                  Traits::kBitsPerSymbol);
+        PackedBitWriter writer(bits.words());
+        qam_detail::slicePacked<Traits::kBitsPerSymbol>(symbols, kSlicer,
+                                                        writer);
+        writer.flush();
+    }
+
+    /**
+     * @brief Hard decisions, one bit per byte, into caller storage.
+     *
+     * @throws std::invalid_argument if the output size does not match
+     */
+    static void demodulate_hard(ConstSampleView symbols,
+                                std::span<uint8_t> bits) {
+        qam_detail::checkHardSize(bits.size(), symbols.size(),
+                                  Traits::kBitsPerSymbol);
+        qam_detail::sliceBytes<Traits::kBitsPerSymbol>(symbols, kSlicer,
+                                                       bits.data());
+    }
+
+    static constexpr int getBitsPerSymbol() noexcept {
+        return Traits::kBitsPerSymbol;
+    }
+    static constexpr int getLevelsCount() noexcept { return M; }
+
+   private:
+    static constexpr simd::AxisSlicer kSlicer{
+        Traits::kAxisMin, 1.0f / Traits::kAxisStep, Traits::kAxisLevels,
+        Traits::kGrid.data()};
+};
+
 /**
  * @brief Class for QAM (Quadrature Amplitude Modulation) demodulator.
  *
- * This class supports hard demodulation for QPSK (4-QAM), 16-QAM, and
- * 64-QAM. It maps received complex symbols back to bit sequences using
- * constellation matching.
+ * This class supports square M-QAM from QPSK (4-QAM) up to 4096-QAM. It
+ * maps received complex symbols back to bit sequences using constellation
+ * matching.
+ *
+ * Square constellations are sliced independently on the I and Q axes, which
+ * costs O(1) per symbol whatever the order and runs on the SIMD kernels from
+ * simd.hpp. The exhaustive nearest-point search, O(M) per symbol, is kept as
+ * a reference mode.
+ *
+ * The order is chosen at runtime; the constellation comes from QamTraits
+ * and the per-axis hard decisions run the same fixed-order kernels as
+ * FixedDemodulatorQAM, selected once at construction.
+ *
+ * Soft decisions produce per-bit log-likelihood ratios
+ * LLR = ln P(b = 0 | y) / P(b = 1 | y), so a positive value favours 0.
  */
 class DemodulatorQAM {
    public:
     /// @brief Type used for numeric representation of constellation points
     using value_type = float;
 
+    /**
+     * @brief Hard-decision engine used by demodulate_hard().
+     *
+     * Both engines return identical bits, except for samples lying exactly
+     * on a decision boundary, where either neighbour is equally close.
+     */
+    enum class HardDecision {
+        PerAxis,    ///< Round/clamp each axis, then look up the symbol index
+        Exhaustive  ///< Compare against every constellation point (reference)
+    };
+
+    /**
+     * @brief LLR computation used by demodulate_soft().
+     *
+     * Every bit of the Gray labelling depends on one axis only, so both
+     * modes work per axis: MaxLog costs O(1) per bit, O(log2 M) per symbol,
+     * and Exact O(sqrt(M)) per bit. A labelling without that property would
+     * make both search all M points.
+     */
+    enum class SoftDecision {
+        MaxLog,  ///< Nearest point with each bit value (max-log-MAP)
+        Exact    ///< Log-sum-exp over all points with each bit value
+    };
+
     /**
      * @brief Construct a new DemodulatorQAM object
      *
-     * @param levels_in Number of constellation points (must be 4, 16, or 64).
+     * @param levels_in Number of constellation points (4, 16, 64, 256, 1024
+     * or 4096).
+     * @param mode Hard-decision engine
+     * @throws std::invalid_argument for any other number of points
      */
-    explicit DemodulatorQAM(int levels_in)
+    explicit DemodulatorQAM(int levels_in,
+                            HardDecision mode = HardDecision::PerAxis)
         : levels_count_(levels_in),
           bits_per_symbol_(calculate_bits_per_symbol(levels_in)) {
-        if (levels_count_ != 4 && levels_count_ != 16 && levels_count_ != 64) {
-            throw std::invalid_argument(
-                "DemodulatorQAM: Only 4, 16, and 64 QAM levels are supported");
+        withQamOrder(levels_count_, [&](auto traits) {
+            using T = decltype(traits);
+            point_re_ = T::kRe.data();
+            point_im_ = T::kIm.data();
+            bit_patterns_ = T::kBitPatterns.data();
+            slicer_ = {T::kAxisMin, 1.0f / T::kAxisStep, T::kAxisLevels,
+                       T::kGrid.data()};
+            axis_values_ = T::kAxisValues.data();
+            separable_ = T::kSoft.separable;
+            soft_axis_ = T::kSoft.axis.data();
+            soft_sign_ = T::kSoft.sign.data();
+            soft_lo_ = T::kSoft.lo.data();
+            soft_hi_ = T::kSoft.hi.data();
+            slice_packed_ = &qam_detail::slicePacked<T::kBitsPerSymbol>;
+            slice_bytes_ = &qam_detail::sliceBytes<T::kBitsPerSymbol>;
+        });
+        mode_ = mode;
+    }
+
+    /**
+     * @brief Perform hard decision demodulation into caller-provided storage.
+     *
+     * Maps each symbol to the closest constellation point and writes the
+     * corresponding bits, one per byte. Does not allocate.
+     *
+     * @param symbols Received symbols as separate I/Q planes
+     * @param bits Output span; its size must be symbols.size() *
+     * BitsPerSymbol
+     * @throws std::invalid_argument if the output size does not match
+     */
+    void demodulate_hard(ConstSampleView symbols,
+                         std::span<uint8_t> bits) const {
+        qam_detail::checkHardSize(bits.size(), symbols.size(),
+                                  bits_per_symbol_);
+        uint8_t* out = bits.data();
+
+        if (mode_ == HardDecision::PerAxis) {
+            slice_bytes_(symbols, slicer_, out);
+        } else {
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                out = writeBits(nearestIndex(symbols.re[i], symbols.im[i]),
+                                out);
+            }
+        }
+    }
+
+    /**
+     * @brief Perform hard decision demodulation into a packed bitstream.
+     *
+     * @param symbols Received symbols as separate I/Q planes
+     * @param bits Output stream; resized to symbols.size() * BitsPerSymbol
+     * bits if needed (no allocation when the size already matches)
+     */
+    void demodulate_hard(ConstSampleView symbols, PackedBits& bits) const {
+        const size_t nbits = symbols.size() * bits_per_symbol_;
+        if (bits.size() != nbits) bits.resize(nbits);
+        demodulate_hard(symbols, bits.view());
+    }
+
+    /**
+     * @brief Perform hard decision demodulation into caller-provided packed
+     * storage.
+     *
+     * Does not allocate; the words need not be zeroed.
+     *
+     * @param symbols Received symbols as separate I/Q planes
+     * @param bits Output view; its size must be symbols.size() *
+     * BitsPerSymbol
+     * @throws std::invalid_argument if the output size does not match
+     */
+    void demodulate_hard(ConstSampleView symbols, PackedBitsView bits) const {
+        qam_detail::checkHardSize(bits.size(), symbols.size(),
+                                  bits_per_symbol_);
+        PackedBitWriter writer(bits.words());
+
+        if (mode_ == HardDecision::PerAxis) {
+            slice_packed_(symbols, slicer_, writer);
+        } else {
+            for (size_t i = 0; i < symbols.size(); ++i) {
+                writer.put(static_cast<uint64_t>(
+                               nearestIndex(symbols.re[i], symbols.im[i])),
+                           bits_per_symbol_);
+            }
         }
-        generateConstellation();
-        generateBitPatterns();
+        writer.flush();
     }
 
     /**
@@ -41,51 +285,113 @@ class DemodulatorQAM {
      * Maps each symbol to the closest constellation point and returns
      * corresponding bits.
      *
+     * @param symbols Received symbols as separate I/Q planes
+     * @return Vector of recovered bits
+     */
+    std::vector<uint8_t> demodulate_hard(ConstSampleView symbols) const {
+        std::vector<uint8_t> bits(symbols.size() * bits_per_symbol_);
+        demodulate_hard(symbols, bits);
+        return bits;
+    }
+
+    /**
+     * @brief Perform hard decision demodulation of received symbols.
+     *
+     * Adapter over the SampleBuffer overload for callers using interleaved
+     * pairs.
+     *
      * @param symbols Received symbols as pairs of (real, imaginary) values
      * @return Vector of recovered bits
      */
     std::vector<uint8_t> demodulate_hard(
         std::span<const std::pair<value_type, value_type>> symbols) const {
-        std::vector<uint8_t> bits;
-        if (symbols.empty()) {
-            return bits;
-        }
-        bits.reserve(symbols.size() * bits_per_symbol_);
-
-        for (const auto& s : symbols) {
-            int best_idx = 0;
-            value_type best_dist_sq =
-                std::numeric_limits<value_type>::infinity();
-
-            for (int idx = 0; idx < levels_count_; ++idx) {
-                value_type dr = s.first - constellation_[idx].first;
-                value_type di = s.second - constellation_[idx].second;
-                value_type dist_sq = dr * dr + di * di;
-                if (dist_sq < best_dist_sq) {
-                    best_dist_sq = dist_sq;
-                    best_idx = idx;
-                }
-            }
-            for (int j = 0; j < bits_per_symbol_; ++j) {
-                bits.push_back(bit_patterns_[best_idx][j] ? 1 : 0);
+        return demodulate_hard(SampleBuffer::fromPairs(symbols).view());
+    }
+
+    /**
+     * @brief Compute per-bit LLRs into caller-provided storage.
+     *
+     * Does not allocate.
+     *
+     * @param symbols Received symbols as separate I/Q planes
+     * @param noise_variance Complex noise variance N0 = E|n|^2 (sigma^2 per
+     * component is N0 / 2); must be positive
+     * @param llrs Output span of symbols.size() * BitsPerSymbol values,
+     * ordered like the bits of demodulate_hard()
+     * @param mode Exact or max-log LLRs
+     * @throws std::invalid_argument on a size mismatch or non-positive N0
+     */
+    void demodulate_soft(ConstSampleView symbols, value_type noise_variance,
+                         std::span<value_type> llrs,
+                         SoftDecision mode = SoftDecision::MaxLog) const {
+        checkSoftArgs(symbols, noise_variance, llrs.size());
+        const value_type inv_n0 = value_type{1} / noise_variance;
+        for (size_t i = 0; i < symbols.size(); i += kSliceTile) {
+            size_t n = std::min(kSliceTile, symbols.size() - i);
+            softTile(symbols.subview(i, n), inv_n0, mode,
+                     llrs.data() + i * bits_per_symbol_);
+        }
+    }
+
+    /**
+     * @brief Compute per-bit LLRs quantized to int8 for a fixed-point decoder.
+     *
+     * Each LLR is multiplied by @p scale, rounded and saturated to
+     * [-127, 127]. Does not allocate.
+     *
+     * @param symbols Received symbols as separate I/Q planes
+     * @param noise_variance Complex noise variance N0; must be positive
+     * @param llrs Output span of symbols.size() * BitsPerSymbol values
+     * @param scale Quantization gain applied before rounding
+     * @param mode Exact or max-log LLRs
+     * @throws std::invalid_argument on a size mismatch or non-positive N0
+     */
+    void demodulate_soft(ConstSampleView symbols, value_type noise_variance,
+                         std::span<int8_t> llrs, value_type scale,
+                         SoftDecision mode = SoftDecision::MaxLog) const {
+        checkSoftArgs(symbols, noise_variance, llrs.size());
+        const value_type inv_n0 = value_type{1} / noise_variance;
+        std::array<value_type, kSliceTile * kMaxBitsPerSymbol> tile;
+        for (size_t i = 0; i < symbols.size(); i += kSliceTile) {
+            size_t n = std::min(kSliceTile, symbols.size() - i);
+            softTile(symbols.subview(i, n), inv_n0, mode, tile.data());
+            int8_t* out = llrs.data() + i * bits_per_symbol_;
+            for (size_t k = 0; k < n * bits_per_symbol_; ++k) {
+                value_type q = std::nearbyint(tile[k] * scale);
+                out[k] = static_cast<int8_t>(std::clamp(q, -127.0f, 127.0f));
             }
         }
-        return bits;
     }
 
+    /**
+     * @brief True if soft decisions run per axis (see SoftDecision)
+     */
+    bool isSoftSeparable() const noexcept { return separable_; }
+
+    /**
+     * @brief Get the hard-decision engine actually in use
+     */
+    HardDecision getHardDecision() const noexcept { return mode_; }
+
     /**
      * @brief Get the constellation diagram used by the demodulator
      */
-    const std::vector<std::pair<value_type, value_type>>& getConstellation()
-        const {
-        return constellation_;
+    std::vector<std::pair<value_type, value_type>> getConstellation() const {
+        std::vector<std::pair<value_type, value_type>> points(levels_count_);
+        for (int i = 0; i < levels_count_; ++i) {
+            points[i] = {point_re_[i], point_im_[i]};
+        }
+        return points;
     }
 
     /**
-     * @brief Get the bit patterns associated with each constellation point
+     * @brief Get the bits (one per byte, MSB first) of a constellation point
+     *
+     * @param index Symbol index in [0, getLevelsCount())
      */
-    const std::vector<std::vector<bool>>& getBitPatterns() const {
-        return bit_patterns_;
+    std::span<const uint8_t> getBitPattern(int index) const {
+        return {bit_patterns_ + index * bits_per_symbol_,
+                static_cast<size_t>(bits_per_symbol_)};
     }
 
     /**
@@ -99,60 +405,171 @@ class DemodulatorQAM {
     constexpr int getLevelsCount() const noexcept { return levels_count_; }
 
    private:
-    static constexpr int calculate_bits_per_symbol(int levels) {
-        if (levels == 4) return 2;
-        if (levels == 16) return 4;
-        if (levels == 64) return 6;
-        throw std::logic_error(
-            "Invalid levels value for BitsPerSymbol calculation");
-    }
-
-    void generateConstellation() {
-        constellation_.clear();
-        constellation_.reserve(levels_count_);
-
-        if (levels_count_ == 4) {  // QPSK
-            constellation_.emplace_back(1.0f, 1.0f);
-            constellation_.emplace_back(-1.0f, 1.0f);
-            constellation_.emplace_back(-1.0f, -1.0f);
-            constellation_.emplace_back(1.0f, -1.0f);
-        } else if (levels_count_ == 16) {  // 16-QAM
-            const value_type pam_levels_arr[] = {-3.0f, -1.0f, 1.0f, 3.0f};
-            for (int index = 0; index < levels_count_; ++index) {
-                int val_x_bits = (index >> (bits_per_symbol_ / 2));
-                int val_y_bits = (index & ((1 << (bits_per_symbol_ / 2)) - 1));
-                int gray_idx_x = val_x_bits ^ (val_x_bits >> 1);
-                int gray_idx_y = val_y_bits ^ (val_y_bits >> 1);
-                constellation_.emplace_back(pam_levels_arr[gray_idx_x],
-                                            pam_levels_arr[gray_idx_y]);
+    /// @brief Symbol index of the closest point by exhaustive search
+    int nearestIndex(value_type re, value_type im) const {
+        int best_idx = 0;
+        value_type best_dist_sq = std::numeric_limits<value_type>::infinity();
+
+        for (int idx = 0; idx < levels_count_; ++idx) {
+            value_type dr = re - point_re_[idx];
+            value_type di = im - point_im_[idx];
+            value_type dist_sq = dr * dr + di * di;
+            if (dist_sq < best_dist_sq) {
+                best_dist_sq = dist_sq;
+                best_idx = idx;
             }
-        } else if (levels_count_ == 64) {  // 64-QAM
-            const value_type pam_levels_arr[] = {-7.0f, -5.0f, -3.0f, -1.0f,
-                                                 1.0f,  3.0f,  5.0f,  7.0f};
-            for (int index = 0; index < levels_count_; ++index) {
-                int val_x_bits = (index >> (bits_per_symbol_ / 2));
-                int val_y_bits = (index & ((1 << (bits_per_symbol_ / 2)) - 1));
-                int gray_idx_x = val_x_bits ^ (val_x_bits >> 1);
-                int gray_idx_y = val_y_bits ^ (val_y_bits >> 1);
-                constellation_.emplace_back(pam_levels_arr[gray_idx_x],
-                                            pam_levels_arr[gray_idx_y]);
+        }
+        return best_idx;
+    }
+
+    static constexpr size_t kSliceTile = qam_detail::kSliceTile;
+    static constexpr int kMaxBitsPerSymbol = qamBitsPerSymbol(kMaxQamLevels);
+
+    /// @brief Running log-sum-exp accumulator
+    struct LogSumExp {
+        value_type max = -std::numeric_limits<value_type>::infinity();
+        value_type sum = 0;
+
+        void add(value_type m) {
+            if (m > max) {
+                sum = sum * std::exp(max - m) + value_type{1};
+                max = m;
+            } else {
+                sum += std::exp(m - max);
             }
         }
+        value_type value() const { return max + std::log(sum); }
+    };
+
+    void checkSoftArgs(ConstSampleView symbols, value_type noise_variance,
+                       size_t out_size) const {
+        if (out_size != symbols.size() * bits_per_symbol_) {
+            throw std::invalid_argument(
+                "DemodulatorQAM: LLR output size must equal symbols * "
+                "BitsPerSymbol");
+        }
+        if (!(noise_variance > 0)) {
+            throw std::invalid_argument(
+                "DemodulatorQAM: noise variance must be positive");
+        }
     }
 
-    void generateBitPatterns() {
-        bit_patterns_.clear();
-        bit_patterns_.resize(levels_count_,
-                             std::vector<bool>(bits_per_symbol_));
-        for (int i = 0; i < levels_count_; ++i) {
-            for (int j = 0; j < bits_per_symbol_; ++j) {
-                bit_patterns_[i][j] = (i >> (bits_per_symbol_ - 1 - j)) & 1;
+    /// @brief LLRs of up to kSliceTile symbols
+    void softTile(ConstSampleView symbols, value_type inv_n0,
+                  SoftDecision mode, value_type* out) const {
+        const size_t n = symbols.size();
+        const int bps = bits_per_symbol_;
+        if (!separable_) {
+            for (size_t s = 0; s < n; ++s) {
+                softFullSearch(symbols.re[s], symbols.im[s], inv_n0, mode,
+                               out + s * bps);
             }
+            return;
+        }
+
+        std::array<int32_t, kSliceTile> k_axis[2];
+        simd::sliceLevels(symbols.re, n, slicer_, k_axis[0].data());
+        simd::sliceLevels(symbols.im, n, slicer_, k_axis[1].data());
+        const int L = slicer_.levels;
+        for (int j = 0; j < bps; ++j) {
+            const int32_t axis = soft_axis_[j];
+            const value_type* sign = soft_sign_ + j * L;
+            const value_type* lo_level = soft_lo_ + j * L;
+            const value_type* hi_level = soft_hi_ + j * L;
+            const value_type* v = axis == 0 ? symbols.re : symbols.im;
+            const int32_t* k = k_axis[axis].data();
+            if (mode == SoftDecision::MaxLog) {
+                // Nearest level carries the own bit value; the nearest
+                // opposite level is the closer of lo / hi.
+                for (size_t s = 0; s < n; ++s) {
+                    const int32_t kk = k[s];
+                    const value_type own = v[s] - axis_values_[kk];
+                    const value_type lo = v[s] - lo_level[kk];
+                    const value_type hi = v[s] - hi_level[kk];
+                    const value_type opp = std::min(lo * lo, hi * hi);
+                    out[s * bps + j] = sign[kk] * (opp - own * own) * inv_n0;
+                }
+            } else {
+                // The other axis contributes the same factor to both sums
+                for (size_t s = 0; s < n; ++s) {
+                    LogSumExp zero, one;
+                    for (int level = 0; level < L; ++level) {
+                        const value_type d = v[s] - axis_values_[level];
+                        const value_type m = -d * d * inv_n0;
+                        (sign[level] > 0 ? zero : one).add(m);
+                    }
+                    out[s * bps + j] = zero.value() - one.value();
+                }
+            }
+        }
+    }
+
+    /// @brief LLRs of one symbol by searching every constellation point
+    void softFullSearch(value_type re, value_type im, value_type inv_n0,
+                        SoftDecision mode, value_type* out) const {
+        const int bps = bits_per_symbol_;
+        std::array<LogSumExp, kMaxBitsPerSymbol> zero, one;
+        for (int idx = 0; idx < levels_count_; ++idx) {
+            value_type dr = re - point_re_[idx];
+            value_type di = im - point_im_[idx];
+            value_type m = -(dr * dr + di * di) * inv_n0;
+            for (int j = 0; j < bps; ++j) {
+                const bool bit = (idx >> (bps - 1 - j)) & 1;
+                LogSumExp& acc = bit ? one[j] : zero[j];
+                if (mode == SoftDecision::MaxLog) {
+                    acc.max = std::max(acc.max, m);
+                } else {
+                    acc.add(m);
+                }
+            }
+        }
+        for (int j = 0; j < bps; ++j) {
+            out[j] = mode == SoftDecision::MaxLog
+                         ? zero[j].max - one[j].max
+                         : zero[j].value() - one[j].value();
         }
     }
 
+    uint8_t* writeBits(int idx, uint8_t* out) const {
+        const uint8_t* pattern = bit_patterns_ + idx * bits_per_symbol_;
+        for (int j = 0; j < bits_per_symbol_; ++j) *out++ = pattern[j];
+        return out;
+    }
+
+    static int calculate_bits_per_symbol(int levels) {
+        if (!isSquareQamOrder(levels)) {
+            throw std::invalid_argument(std::string("DemodulatorQAM: ") +
+                                        kUnsupportedQamOrder);
+        }
+        return qamBitsPerSymbol(levels);
+    }
+
     const int levels_count_;
     const int bits_per_symbol_;
-    std::vector<std::pair<value_type, value_type>> constellation_;
-    std::vector<std::vector<bool>> bit_patterns_;
+    HardDecision mode_ = HardDecision::PerAxis;
+
+    // Tables are the constexpr ones of QamTraits<levels_count_>, in
+    // .rodata, so copies share them and construction never allocates.
+    const value_type* point_re_ = nullptr;
+    const value_type* point_im_ = nullptr;
+    /// @brief levels x bits, MSB first
+    const uint8_t* bit_patterns_ = nullptr;
+    /// @brief Per-axis slicing parameters and the QamTraits grid
+    simd::AxisSlicer slicer_{};
+
+    bool separable_ = false;  ///< Soft decisions run per axis
+    /// @brief PAM level values, slicer_.levels of them
+    const value_type* axis_values_ = nullptr;
+    /// @brief Soft tables (see qam_detail::AxisSoftTables): the axis of
+    /// each bit, then bits x levels of sign and nearest opposite levels
+    const int32_t* soft_axis_ = nullptr;
+    const value_type* soft_sign_ = nullptr;
+    const value_type* soft_lo_ = nullptr;
+    const value_type* soft_hi_ = nullptr;
+
+    /// @brief Fixed-order per-axis kernels matching levels_count_
+    void (*slice_packed_)(ConstSampleView, const simd::AxisSlicer&,
+                          PackedBitWriter&) = nullptr;
+    void (*slice_bytes_)(ConstSampleView, const simd::AxisSlicer&,
+                         uint8_t*) = nullptr;
 };
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "qam_simulator/pipeline.hpp"
+#include "qam_simulator/sweep.hpp"
+
+/**
+ * @file
+ * @brief Distributed sweep mode (--serve=, --connect=).
+ *
+ * A coordinator hands (modulation, SNR, block) units to workers over TCP
+ * (net.hpp) and folds their counts in block order; the workers rebuild the
+ * sweep from the parameters the coordinator sends and run the units with
+ * run_block(). A session is a hello from the worker, the sweep parameters
+ * back, then one results message per batch, each answered with the next
+ * batch, until an empty batch ends it.
+ */
+
+/**
+ * @brief Serve workers on @p port until every point of @p jobs has
+ * converged or counted its budget, then leave the totals in the jobs.
+ *
+ * Units of a worker that disconnects, or that has not answered when its
+ * batch's lease (SimulationParams::lease_s) runs out, are handed to the
+ * others, so a lost or stalled node only costs time. The totals equal
+ * those of a single-process run with the same seed and budget.
+ *
+ * @param checkpointer Written as counts come in; may be null
+ * @throws std::runtime_error if the port cannot be bound
+ */
+void run_coordinator(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                     const SimulationParams& params,
+                     Checkpointer* checkpointer, uint16_t port);
+
+/**
+ * @brief Runs units from the coordinator at p.connect_to on p.num_threads
+ * threads until it reports the sweep finished.
+ *
+ * @throws std::runtime_error if the coordinator cannot be reached, sends
+ * a bad configuration or goes away
+ */
+void run_worker(const SimulationParams& local);
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @file
+ * @brief Optional CUDA backend of the sweep (--backend=cuda).
+ *
+ * Configure with -DQAM_ENABLE_CUDA=ON to build it (needs the CUDA toolkit)
+ * and define QAM_CUDA=1. Without it the same interface is compiled from a
+ * stub whose BlockRunner constructor throws, so the CPU build needs no
+ * CUDA headers.
+ *
+ * The device runs the whole chain of a block in one fused kernel: each
+ * thread draws the bits of its symbols and their noise from two Philox
+ * streams keyed by the block's seeds (see blockSeeds()), maps the bits to
+ * the Gray-labelled square constellation, slices both axes and counts the
+ * bit errors. Counts are reduced per warp and per thread block on the
+ * device, and only one counter per simulated block goes back to the host.
+ * The streams differ from the CPU engines', so counts agree with the CPU
+ * path statistically rather than bit for bit (see
+ * scripts/compare_ber.py).
+ *
+ * runSweep() and replayBlock() are the host side of the backend: they
+ * batch the blocks of each point, derive their seeds and fold the counts
+ * in block order. They are compiled in either build (gpu_sweep.cpp).
+ */
+
+#ifndef QAM_CUDA
+#define QAM_CUDA 0
+#endif
+
+struct ModulationJob;
+class Checkpointer;
+
+namespace gpu {
+
+/// @brief True if the build has the CUDA backend compiled in
+constexpr bool enabled() noexcept { return QAM_CUDA != 0; }
+
+/**
+ * @brief Consecutive blocks of one (modulation, SNR) point, as run by one
+ * launch.
+ */
+struct BlockBatch {
+    int levels = 0;           ///< Constellation order M (square, 4 to 4096)
+    float sigma = 0.0f;       ///< Noise sigma per component, unscaled points
+    uint64_t block_bits = 0;  ///< Bits per block, a multiple of log2(M)
+    /// @brief Bit and noise seeds of each block, blockSeeds() order
+    std::span<const uint64_t> bit_seeds;
+    std::span<const uint64_t> noise_seeds;
+};
+
+/**
+ * @brief Runs batches of blocks on one CUDA device.
+ *
+ * Holds the device and its counter buffer for the whole sweep, so a batch
+ * costs one launch and two small copies. Not thread safe.
+ */
+class BlockRunner {
+   public:
+    /**
+     * @brief Claim device 0 and room for @p max_blocks blocks per batch.
+     *
+     * @throws std::runtime_error if the build has no CUDA backend or no
+     * device is usable
+     */
+    explicit BlockRunner(size_t max_blocks);
+    ~BlockRunner();
+
+    BlockRunner(const BlockRunner&) = delete;
+    BlockRunner& operator=(const BlockRunner&) = delete;
+
+    /**
+     * @brief Run every block of @p batch and write the bit errors of block
+     * k to @p errors[k].
+     *
+     * @throws std::invalid_argument if the batch is larger than the runner
+     * or its spans differ in size
+     * @throws std::runtime_error if the device reports an error
+     */
+    void run(const BlockBatch& batch, std::span<uint64_t> errors);
+
+    /// @brief Blocks a batch may hold
+    size_t maxBlocks() const noexcept { return max_blocks_; }
+
+    /// @brief Device name and compute capability, for the run header
+    std::string describe() const;
+
+   private:
+    struct Impl;  ///< Device buffers; defined by the backend
+    std::unique_ptr<Impl> impl_;
+    size_t max_blocks_ = 0;
+};
+
+/**
+ * @brief Runs every SNR point of @p jobs on the CUDA backend, one point
+ * after another.
+ *
+ * Each launch runs the point's next blocks, up to about 2^32 bits; their
+ * counts are folded in block order, so the stopping rule, checkpoints and
+ * resume behave as with the CPU kernels. A launch may overshoot the block
+ * the rule holds at; those blocks are not counted.
+ *
+ * @param checkpointer Written between launches; null for none
+ * @throws std::runtime_error if the device fails
+ */
+void runSweep(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+              Checkpointer* checkpointer);
+
+/**
+ * @brief Bit errors of block @p block of SNR point @p snr_index of @p job,
+ * run alone on the device (--replay= with --backend=cuda).
+ *
+ * @throws std::runtime_error if the device fails
+ */
+uint64_t replayBlock(const ModulationJob& job, size_t snr_index,
+                     uint64_t block);
+
+}  // namespace gpu
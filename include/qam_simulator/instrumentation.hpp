@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "qam_simulator/alloc_counter.hpp"
+
+/**
+ * @file
+ * @brief Optional hot-path instrumentation of the simulation kernels.
+ *
+ * Configure with -DQAM_ENABLE_INSTRUMENTATION=ON to define
+ * QAM_INSTRUMENTATION=1. The macros below then time each kernel stage in
+ * nanoseconds, count the heap allocations the stage makes, and record the
+ * symbols processed and the time pool workers spend idle. Counters live in
+ * one cache-line aligned record per thread, written only by that thread,
+ * and are read once the work has finished. With instrumentation disabled
+ * every macro expands to nothing (QAM_INSTR_TIME just evaluates its
+ * statement).
+ */
+
+#ifndef QAM_INSTRUMENTATION
+#define QAM_INSTRUMENTATION 0
+#endif
+
+namespace instr {
+
+/// @brief Instrumented kernel stages
+enum class Stage { Bits, Modulate, Noise, Demodulate, Count };
+inline constexpr size_t kStageCount = 5;
+
+/// @brief Short stage name used in the report and the JSON keys
+const char* stageName(Stage stage) noexcept;
+
+/// @brief True if the build has instrumentation compiled in
+constexpr bool enabled() noexcept { return QAM_INSTRUMENTATION != 0; }
+
+/**
+ * @brief Counters of one thread.
+ */
+struct alignas(64) ThreadCounters {
+    std::array<uint64_t, kStageCount> stage_ns{};
+    std::array<uint64_t, kStageCount> stage_calls{};
+    std::array<uint64_t, kStageCount> stage_allocations{};
+    uint64_t symbols = 0;  ///< Symbols pushed through the kernel
+    uint64_t idle_ns = 0;  ///< Time spent waiting for work
+};
+
+/**
+ * @brief Counters of the calling thread, registered on first use.
+ *
+ * Records outlive their threads, so a report can be written after a pool
+ * has shut down. Registration allocates; pool workers register when they
+ * start, so nothing is allocated inside an instrumented kernel.
+ */
+ThreadCounters& threadCounters();
+
+/// @brief Zero the counters of every registered thread
+void reset();
+
+/**
+ * @brief Print per-stage and per-thread summary tables.
+ *
+ * @param wall_s Wall time of the instrumented run, for the share columns
+ */
+void writeReport(std::ostream& os, double wall_s);
+
+/**
+ * @brief Write the same data as writeReport() as JSON.
+ *
+ * @return false if the file could not be written
+ */
+bool writeJson(const std::string& path, double wall_s);
+
+/**
+ * @brief Adds the lifetime of the scope to a stage of this thread.
+ */
+class ScopedStage {
+   public:
+    explicit ScopedStage(Stage stage)
+        : counters_(threadCounters()),
+          index_(static_cast<size_t>(stage)),
+          allocations_(thread_allocation_count()),
+          start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedStage() {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_);
+        counters_.stage_ns[index_] += static_cast<uint64_t>(ns.count());
+        counters_.stage_calls[index_] += 1;
+        counters_.stage_allocations[index_] +=
+            thread_allocation_count() - allocations_;
+    }
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+   private:
+    ThreadCounters& counters_;
+    size_t index_;
+    uint64_t allocations_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief Adds the lifetime of the scope to this thread's idle time.
+ */
+class ScopedIdle {
+   public:
+    ScopedIdle()
+        : counters_(threadCounters()),
+          start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedIdle() {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_);
+        counters_.idle_ns += static_cast<uint64_t>(ns.count());
+    }
+
+    ScopedIdle(const ScopedIdle&) = delete;
+    ScopedIdle& operator=(const ScopedIdle&) = delete;
+
+   private:
+    ThreadCounters& counters_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace instr
+
+#define QAM_INSTR_CONCAT_(a, b) a##b
+#define QAM_INSTR_CONCAT(a, b) QAM_INSTR_CONCAT_(a, b)
+
+#if QAM_INSTRUMENTATION
+/// @brief Time @p statement as stage instr::Stage::@p stage
+#define QAM_INSTR_TIME(stage, statement)                               \
+    do {                                                               \
+        ::instr::ScopedStage qam_instr_stage_(::instr::Stage::stage);  \
+        statement;                                                     \
+    } while (0)
+/// @brief Count the rest of the enclosing scope as idle time
+#define QAM_INSTR_IDLE_SCOPE() \
+    ::instr::ScopedIdle QAM_INSTR_CONCAT(qam_instr_idle_, __LINE__)
+/// @brief Add @p n to the symbols processed by this thread
+#define QAM_INSTR_SYMBOLS(n) (::instr::threadCounters().symbols += (n))
+/// @brief Register the calling thread's counters ahead of any kernel
+#define QAM_INSTR_REGISTER_THREAD() ((void)::instr::threadCounters())
+#else
+#define QAM_INSTR_TIME(stage, statement) \
+    do {                                 \
+        statement;                       \
+    } while (0)
+#define QAM_INSTR_IDLE_SCOPE() ((void)0)
+#define QAM_INSTR_SYMBOLS(n) ((void)0)
+#define QAM_INSTR_REGISTER_THREAD() ((void)0)
+#endif
@@ -1,18 +1,192 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstdint>
 #include <span>
 #include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "qam_simulator/aligned_allocator.hpp"
+#include "qam_simulator/packed_bits.hpp"
+#include "qam_simulator/qam_traits.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+#include "qam_simulator/simd.hpp"
+
+namespace qam_detail {
+
+/// @brief Symbols gathered per SIMD call
+inline constexpr size_t kGatherTile = 256;
+
+/**
+ * @brief Map one-bit-per-byte input to symbols for a fixed bit count.
+ *
+ * @p bits holds out.size() * Bps bytes; sizes are checked by the caller.
+ */
+template <int Bps>
+void modulateBytes(const uint8_t* bits, const float* table_re,
+                   const float* table_im, SampleView out) {
+    std::array<int32_t, kGatherTile> idx;
+    for (size_t i = 0; i < out.size(); i += kGatherTile) {
+        size_t n = std::min(kGatherTile, out.size() - i);
+        const uint8_t* b = bits + i * Bps;
+        for (size_t k = 0; k < n; ++k, b += Bps) {
+            int32_t symbol_index = 0;
+            for (int j = 0; j < Bps; ++j) {
+                symbol_index = (symbol_index << 1) | b[j];
+            }
+            idx[k] = symbol_index;
+        }
+        simd::gather(idx.data(), n, table_re, table_im, out.re + i,
+                     out.im + i);
+    }
+}
+
+/**
+ * @brief Symbol indices of @p n symbols of a packed stream, from @p first.
+ *
+ * When Bps divides 64 no symbol straddles a word, so each index is a shift
+ * and mask of a single word.
+ */
+template <int Bps>
+void packedIndices(ConstPackedBitsView bits, size_t first, size_t n,
+                   int32_t* idx) {
+    constexpr uint64_t kMask = (uint64_t{1} << Bps) - 1;
+    const auto words = bits.words();
+    for (size_t k = 0; k < n; ++k) {
+        const size_t s = first + k;
+        if constexpr (64 % Bps == 0) {
+            constexpr size_t kPerWord = 64 / Bps;
+            const int shift = static_cast<int>(64 - Bps * (s % kPerWord + 1));
+            idx[k] = static_cast<int32_t>((words[s / kPerWord] >> shift) &
+                                          kMask);
+        } else {
+            idx[k] = static_cast<int32_t>(bits.read(s * Bps, Bps));
+        }
+    }
+}
+
+/**
+ * @brief Map symbols [first, first + out.size()) of a packed bitstream to
+ * samples for a fixed bit count.
+ *
+ * Sizes are checked by the caller.
+ */
+template <int Bps>
+void modulatePacked(ConstPackedBitsView bits, size_t first,
+                    const float* table_re, const float* table_im,
+                    SampleView out) {
+    std::array<int32_t, kGatherTile> idx;
+    for (size_t i = 0; i < out.size(); i += kGatherTile) {
+        size_t n = std::min(kGatherTile, out.size() - i);
+        packedIndices<Bps>(bits, first + i, n, idx.data());
+        simd::gather(idx.data(), n, table_re, table_im, out.re + i,
+                     out.im + i);
+    }
+}
+
+/**
+ * @brief Mean |s|^2 of the symbols a packed stream maps to.
+ *
+ * Accumulates in double in symbol order, exactly like the empirical power
+ * of NoiseAdder::addNoise(), without materializing the symbols.
+ */
+template <int Bps>
+double packedPower(ConstPackedBitsView bits, const float* table_re,
+                   const float* table_im) {
+    const size_t num_symbols = bits.size() / Bps;
+    if (num_symbols == 0) return 0.0;
+    std::array<int32_t, kGatherTile> idx;
+    double power = 0.0;
+    for (size_t i = 0; i < num_symbols; i += kGatherTile) {
+        size_t n = std::min(kGatherTile, num_symbols - i);
+        packedIndices<Bps>(bits, i, n, idx.data());
+        for (size_t k = 0; k < n; ++k) {
+            double re = static_cast<double>(table_re[idx[k]]);
+            double im = static_cast<double>(table_im[idx[k]]);
+            power += re * re + im * im;
+        }
+    }
+    return power / static_cast<double>(num_symbols);
+}
+
+/// @brief Validate that @p nbits bits map onto @p num_symbols symbols
+inline void checkModulateSizes(size_t nbits, int bps, size_t num_symbols) {
+    if (nbits % bps != 0) {
+        throw std::invalid_argument(
+            "Bit count must be divisible by BitsPerSymbol");
+    }
+    if (num_symbols != nbits / bps) {
+        throw std::invalid_argument(
+            "ModulatorQAM: output size must equal the symbol count");
+    }
+}
+
+}  // namespace qam_detail
+
+/**
+ * @brief QAM modulator for a constellation order fixed at compile time.
+ *
+ * Uses the unscaled constellation of QamTraits<M> straight from .rodata,
+ * and its bit count as a constant, so the index extraction loops unroll
+ * fully. ModulatorQAM dispatches to the same kernels at runtime.
+ *
+ * @tparam M Number of constellation points (4^k, 4 to 4096)
+ */
+template <int M>
+class FixedModulatorQAM {
+   public:
+    using Traits = QamTraits<M>;
+    using value_type = typename Traits::value_type;
+
+    /**
+     * @brief Modulate a packed bitstream into caller-provided storage
+     *
+     * @throws std::invalid_argument if number of bits is not divisible by
+     * BitsPerSymbol or the output size does not match
+     */
+    static void modulate(ConstPackedBitsView bits, SampleView out) {
+        qam_detail::checkModulateSizes(bits.size(), Traits::kBitsPerSymbol,
+                                       out.size());
+        qam_detail::modulatePacked<Traits::kBitsPerSymbol>(
+            bits, 0, Traits::kRe.data(), Traits::kIm.data(), out);
+    }
+
+    /**
+     * @brief Modulate one-bit-per-byte input into caller-provided storage
+     *
+     * @throws std::invalid_argument if number of bits is not divisible by
+     * BitsPerSymbol or the output size does not match
+     */
+    static void modulate(std::span<const uint8_t> bits, SampleView out) {
+        qam_detail::checkModulateSizes(bits.size(), Traits::kBitsPerSymbol,
+                                       out.size());
+        qam_detail::modulateBytes<Traits::kBitsPerSymbol>(
+            bits.data(), Traits::kRe.data(), Traits::kIm.data(), out);
+    }
+
+    static constexpr value_type getAveragePower() noexcept {
+        return Traits::kAveragePower;
+    }
+    static constexpr int getBitsPerSymbol() noexcept {
+        return Traits::kBitsPerSymbol;
+    }
+    static constexpr int getLevelsCount() noexcept { return M; }
+};
+
 /**
  * @brief Class for QAM (Quadrature Amplitude Modulation) modulator.
  *
- * This class supports QPSK (4-QAM), 16-QAM, and 64-QAM modulation schemes.
- * It maps a sequence of bits to complex symbols based on the constellation
+ * This class supports square M-QAM from QPSK (4-QAM) up to 4096-QAM. It
+ * maps a sequence of bits to complex symbols based on the constellation
  * diagram using Gray coding to minimize bit errors.
+ *
+ * The order is chosen at runtime; the constellation comes from QamTraits
+ * and the hot loops run the same fixed-order kernels as FixedModulatorQAM,
+ * selected once at construction.
  */
 class ModulatorQAM {
    public:
@@ -22,51 +196,146 @@ class ModulatorQAM {
     /**
      * @brief Construct a new ModulatorQAM object
      *
-     * @param levels_in Number of constellation points (must be 4, 16, or 64).
+     * @param levels_in Number of constellation points (4, 16, 64, 256, 1024
+     * or 4096).
      * @param scale_factor Scaling factor applied to all constellation points
+     * @throws std::invalid_argument for any other number of points
      */
     explicit ModulatorQAM(int levels_in, value_type scale_factor = 1.0f)
         : levels_count_(levels_in),
           bits_per_symbol_(calculate_bits_per_symbol(levels_in)),
           scale_factor_(scale_factor) {
-        if (levels_count_ != 4 && levels_count_ != 16 && levels_count_ != 64) {
+        withQamOrder(levels_count_, [&](auto traits) {
+            using T = decltype(traits);
+            generateConstellation(T::kRe.data(), T::kIm.data(), T::kLevels);
+            modulate_bytes_ = &qam_detail::modulateBytes<T::kBitsPerSymbol>;
+            modulate_packed_ = &qam_detail::modulatePacked<T::kBitsPerSymbol>;
+            packed_power_ = &qam_detail::packedPower<T::kBitsPerSymbol>;
+        });
+    }
+
+    /**
+     * @brief Modulate a sequence of bits into caller-provided storage
+     *
+     * Does not allocate.
+     *
+     * @param bits Input bit stream as a span of bytes
+     * @param out View receiving one sample per symbol; its size must be
+     * bits.size() / BitsPerSymbol
+     * @throws std::invalid_argument if number of bits is not divisible by
+     * BitsPerSymbol or the output size does not match
+     */
+    void modulate(std::span<const uint8_t> bits, SampleView out) const {
+        qam_detail::checkModulateSizes(bits.size(), bits_per_symbol_,
+                                       out.size());
+        modulate_bytes_(bits.data(), tableRe(), tableIm(), out);
+    }
+
+    /**
+     * @brief Modulate a packed bitstream into caller-provided storage
+     *
+     * Does not allocate.
+     *
+     * @param bits Input bits, MSB-first packed
+     * @param out View receiving one sample per symbol; its size must be
+     * bits.size() / BitsPerSymbol
+     * @throws std::invalid_argument if number of bits is not divisible by
+     * BitsPerSymbol or the output size does not match
+     */
+    void modulate(ConstPackedBitsView bits, SampleView out) const {
+        qam_detail::checkModulateSizes(bits.size(), bits_per_symbol_,
+                                       out.size());
+        modulate_packed_(bits, 0, tableRe(), tableIm(), out);
+    }
+
+    /**
+     * @brief Modulate a run of symbols of a packed bitstream
+     *
+     * Maps symbols [first_symbol, first_symbol + out.size()) of @p bits, so
+     * a block can be processed tile by tile. Does not allocate.
+     *
+     * @param bits Input bits, MSB-first packed
+     * @param first_symbol Index of the first symbol to modulate
+     * @param out View receiving one sample per symbol
+     * @throws std::invalid_argument if the run extends past the last symbol
+     */
+    void modulate(ConstPackedBitsView bits, size_t first_symbol,
+                  SampleView out) const {
+        if (first_symbol + out.size() > bits.size() / bits_per_symbol_) {
             throw std::invalid_argument(
-                "ModulatorQAM: Only 4, 16, and 64 QAM levels are supported");
+                "ModulatorQAM: symbol run extends past the end of the bits");
         }
-        generateConstellation();
+        modulate_packed_(bits, first_symbol, tableRe(), tableIm(), out);
     }
 
     /**
-     * @brief Modulate a sequence of bits into complex symbols
+     * @brief Mean power of the symbols a packed bitstream maps to
+     *
+     * Equals the empirical power NoiseAdder measures on the modulated block,
+     * bit for bit, without materializing the symbols.
      *
-     * @param bits Input bit stream as a span of bytes
-     * @return Vector of modulated symbols represented as (real, imaginary)
-     * pairs
      * @throws std::invalid_argument if number of bits is not divisible by
      * BitsPerSymbol
      */
-    std::vector<std::pair<value_type, value_type>> modulate(
-        std::span<const uint8_t> bits) const {
+    double symbolPower(ConstPackedBitsView bits) const {
         if (bits.size() % bits_per_symbol_ != 0) {
             throw std::invalid_argument(
                 "Bit count must be divisible by BitsPerSymbol");
         }
-        if (bits.empty()) {
-            return {};
-        }
+        return packed_power_(bits, tableRe(), tableIm());
+    }
 
-        size_t num_symbols = bits.size() / bits_per_symbol_;
-        std::vector<std::pair<value_type, value_type>> symbols(num_symbols);
+    /**
+     * @brief Modulate a packed bitstream into complex symbols
+     *
+     * @param bits Input bits, MSB-first packed
+     * @param out Buffer receiving one sample per symbol; resized to fit
+     * @throws std::invalid_argument if number of bits is not divisible by
+     * BitsPerSymbol
+     */
+    void modulate(const PackedBits& bits, SampleBuffer& out) const {
+        if (bits.size() % bits_per_symbol_ != 0) {
+            throw std::invalid_argument(
+                "Bit count must be divisible by BitsPerSymbol");
+        }
+        out.resize(bits.size() / bits_per_symbol_);
+        modulate(bits, out.view());
+    }
 
-        for (size_t i = 0; i < num_symbols; ++i) {
-            int symbol_index = 0;
-            for (int j = 0; j < bits_per_symbol_; ++j) {
-                symbol_index =
-                    (symbol_index << 1) | bits[i * bits_per_symbol_ + j];
-            }
-            symbols[i] = constellation_[symbol_index];
+    /**
+     * @brief Modulate a sequence of bits into complex symbols
+     *
+     * @param bits Input bit stream as a span of bytes
+     * @param out Buffer receiving one sample per symbol; resized to fit
+     * @throws std::invalid_argument if number of bits is not divisible by
+     * BitsPerSymbol
+     */
+    void modulate(std::span<const uint8_t> bits, SampleBuffer& out) const {
+        if (bits.size() % bits_per_symbol_ != 0) {
+            throw std::invalid_argument(
+                "Bit count must be divisible by BitsPerSymbol");
         }
-        return symbols;
+        out.resize(bits.size() / bits_per_symbol_);
+        modulate(bits, out.view());
+    }
+
+    /**
+     * @brief Modulate a sequence of bits into complex symbols
+     *
+     * Adapter over the SampleBuffer overload for callers using interleaved
+     * pairs.
+     *
+     * @param bits Input bit stream as a span of bytes
+     * @return Vector of modulated symbols represented as (real, imaginary)
+     * pairs
+     * @throws std::invalid_argument if number of bits is not divisible by
+     * BitsPerSymbol
+     */
+    std::vector<std::pair<value_type, value_type>> modulate(
+        std::span<const uint8_t> bits) const {
+        SampleBuffer symbols;
+        modulate(bits, symbols);
+        return toPairs(symbols);
     }
 
     /**
@@ -85,64 +354,67 @@ class ModulatorQAM {
     constexpr int getLevelsCount() const noexcept { return levels_count_; }
 
    private:
-    static constexpr int calculate_bits_per_symbol(int levels) {
-        if (levels == 4) return 2;
-        if (levels == 16) return 4;
-        if (levels == 64) return 6;
-        throw std::logic_error(
-            "Invalid levels value for BitsPerSymbol calculation");
-    }
-
-    void generateConstellation() {
-        constellation_.clear();
-        constellation_.reserve(levels_count_);
-
-        if (levels_count_ == 4) {  // QPSK
-            constellation_.emplace_back(1.0f, 1.0f);
-            constellation_.emplace_back(-1.0f, 1.0f);
-            constellation_.emplace_back(-1.0f, -1.0f);
-            constellation_.emplace_back(1.0f, -1.0f);
-        } else if (levels_count_ == 16) {  // 16-QAM
-            const value_type pam_levels_arr[] = {-3.0f, -1.0f, 1.0f, 3.0f};
-            for (int index = 0; index < levels_count_; ++index) {
-                int val_x_bits = (index >> (bits_per_symbol_ / 2));
-                int val_y_bits = (index & ((1 << (bits_per_symbol_ / 2)) - 1));
-                int gray_idx_x = val_x_bits ^ (val_x_bits >> 1);
-                int gray_idx_y = val_y_bits ^ (val_y_bits >> 1);
-                constellation_.emplace_back(pam_levels_arr[gray_idx_x],
-                                            pam_levels_arr[gray_idx_y]);
-            }
-        } else if (levels_count_ == 64) {  // 64-QAM
-            const value_type pam_levels_arr[] = {-7.0f, -5.0f, -3.0f, -1.0f,
-                                                 1.0f,  3.0f,  5.0f,  7.0f};
-            for (int index = 0; index < levels_count_; ++index) {
-                int val_x_bits = (index >> (bits_per_symbol_ / 2));
-                int val_y_bits = (index & ((1 << (bits_per_symbol_ / 2)) - 1));
-                int gray_idx_x = val_x_bits ^ (val_x_bits >> 1);
-                int gray_idx_y = val_y_bits ^ (val_y_bits >> 1);
-                constellation_.emplace_back(pam_levels_arr[gray_idx_x],
-                                            pam_levels_arr[gray_idx_y]);
-            }
+    static int calculate_bits_per_symbol(int levels) {
+        if (!isSquareQamOrder(levels)) {
+            throw std::invalid_argument(std::string("ModulatorQAM: ") +
+                                        kUnsupportedQamOrder);
         }
+        return qamBitsPerSymbol(levels);
+    }
 
-        avg_power_ = 0.0f;
-        for (auto& point : constellation_) {
-            point.first *= scale_factor_;
-            point.second *= scale_factor_;
-            avg_power_ +=
-                point.first * point.first + point.second * point.second;
-        }
-        if (levels_count_ > 0) {
-            avg_power_ /= static_cast<value_type>(levels_count_);
+    /**
+     * @brief Point at the QamTraits tables, or at a scaled copy of them
+     * when scale_factor_ is not 1.
+     */
+    void generateConstellation(const value_type* re, const value_type* im,
+                               int points) {
+        if (scale_factor_ == 1.0f) {
+            base_re_ = re;
+            base_im_ = im;
         } else {
-            avg_power_ = 0.0f;
+            scaled_.resize(2 * static_cast<size_t>(points));
+            for (int i = 0; i < points; ++i) {
+                scaled_[i] = re[i] * scale_factor_;
+                scaled_[points + i] = im[i] * scale_factor_;
+            }
+        }
+        const value_type* table_re = tableRe();
+        const value_type* table_im = tableIm();
+        avg_power_ = 0.0f;
+        for (int i = 0; i < points; ++i) {
+            avg_power_ += table_re[i] * table_re[i] + table_im[i] * table_im[i];
         }
+        avg_power_ /= static_cast<value_type>(points);
+    }
+
+    /// @brief I plane of the constellation used by the kernels
+    const value_type* tableRe() const noexcept {
+        return scaled_.empty() ? base_re_ : scaled_.data();
+    }
+
+    /// @brief Q plane of the constellation used by the kernels
+    const value_type* tableIm() const noexcept {
+        return scaled_.empty() ? base_im_ : scaled_.data() + levels_count_;
     }
 
     const int levels_count_;
     const int bits_per_symbol_;
     const value_type scale_factor_;
 
-    std::vector<std::pair<value_type, value_type>> constellation_;
-    value_type avg_power_;
+    /// @brief Unscaled constellation, the .rodata tables of QamTraits
+    const value_type* base_re_ = nullptr;
+    const value_type* base_im_ = nullptr;
+    /// @brief I then Q plane of a scaled constellation, sized for the
+    /// order; empty at scale 1. Found through tableRe() / tableIm(), so
+    /// copies use their own.
+    std::vector<value_type, AlignedAllocator<value_type>> scaled_;
+    value_type avg_power_ = 0.0f;
+
+    /// @brief Fixed-order kernels matching levels_count_
+    void (*modulate_bytes_)(const uint8_t*, const value_type*,
+                            const value_type*, SampleView) = nullptr;
+    void (*modulate_packed_)(ConstPackedBitsView, size_t, const value_type*,
+                             const value_type*, SampleView) = nullptr;
+    double (*packed_power_)(ConstPackedBitsView, const value_type*,
+                            const value_type*) = nullptr;
 };
\ No newline at end of file
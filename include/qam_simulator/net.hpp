@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @file
+ * @brief Minimal blocking TCP transport for the distributed sweep mode.
+ *
+ * Messages are a {uint32 type, uint32 size} header followed by @c size
+ * bytes of payload. Payloads are packed native-endian values built with
+ * MessageWriter and read back with MessageReader, so coordinator and
+ * workers must share a byte order (every supported host is
+ * little-endian). POSIX sockets only.
+ */
+
+/**
+ * @brief Connected TCP stream socket (move-only, closed on destruction).
+ */
+class Socket {
+   public:
+    Socket() = default;
+    explicit Socket(int fd) noexcept : fd_(fd) {}
+    ~Socket();
+
+    Socket(Socket&& other) noexcept;
+    Socket& operator=(Socket&& other) noexcept;
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    /**
+     * @brief Connect to @p host : @p port.
+     *
+     * @throws std::runtime_error if no address of @p host accepts
+     */
+    static Socket connect(const std::string& host, uint16_t port);
+
+    /// @brief Send all @p size bytes; false once the peer is gone
+    bool sendAll(const void* data, size_t size);
+
+    /**
+     * @brief Receive exactly @p size bytes, waiting at most @p timeout_ms
+     * for each chunk (-1 waits forever).
+     *
+     * @return false on EOF, error or timeout
+     */
+    bool recvAll(void* data, size_t size, int timeout_ms = -1);
+
+    /// @brief Wait up to @p timeout_ms for data (or EOF) to read
+    bool waitReadable(int timeout_ms);
+
+    /**
+     * @brief Receive up to @p size bytes, waiting at most @p timeout_ms
+     * for the first.
+     *
+     * @return Bytes received; 0 on timeout, EOF or error
+     */
+    size_t recvSome(void* data, size_t size, int timeout_ms);
+
+    bool valid() const noexcept { return fd_ >= 0; }
+
+   private:
+    int fd_ = -1;
+};
+
+/**
+ * @brief Listening TCP socket on all interfaces.
+ */
+class Listener {
+   public:
+    /**
+     * @brief Listen on @p port (0 picks a free port, see port()).
+     *
+     * @throws std::runtime_error if the port cannot be bound
+     */
+    explicit Listener(uint16_t port);
+    ~Listener();
+
+    Listener(const Listener&) = delete;
+    Listener& operator=(const Listener&) = delete;
+
+    /**
+     * @brief Wait up to @p timeout_ms for a connection.
+     *
+     * @return The connection, or an invalid Socket on timeout
+     */
+    Socket accept(int timeout_ms);
+
+    /// @brief Port actually bound
+    uint16_t port() const noexcept { return port_; }
+
+   private:
+    int fd_ = -1;
+    uint16_t port_ = 0;
+};
+
+/**
+ * @brief Appends trivially copyable values to a message payload.
+ */
+class MessageWriter {
+   public:
+    template <typename T>
+    MessageWriter& put(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto* p = reinterpret_cast<const std::byte*>(&value);
+        bytes_.insert(bytes_.end(), p, p + sizeof(T));
+        return *this;
+    }
+
+    const std::vector<std::byte>& bytes() const noexcept { return bytes_; }
+    void clear() noexcept { bytes_.clear(); }
+
+   private:
+    std::vector<std::byte> bytes_;
+};
+
+/**
+ * @brief Reads values back from a payload in the order they were put.
+ */
+class MessageReader {
+   public:
+    explicit MessageReader(const std::vector<std::byte>& bytes) noexcept
+        : bytes_(bytes) {}
+
+    /**
+     * @throws std::runtime_error if the payload is too short
+     */
+    template <typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (bytes_.size() - offset_ < sizeof(T)) {
+            throw std::runtime_error("net: truncated message");
+        }
+        T value;
+        std::memcpy(&value, bytes_.data() + offset_, sizeof(T));
+        offset_ += sizeof(T);
+        return value;
+    }
+
+   private:
+    const std::vector<std::byte>& bytes_;
+    size_t offset_ = 0;
+};
+
+/// @brief Send one framed message; false once the peer is gone
+bool sendMessage(Socket& socket, uint32_t type,
+                 const std::vector<std::byte>& payload);
+
+/**
+ * @brief Receive one framed message, waiting at most @p timeout_ms for each
+ * chunk of it (-1 waits forever).
+ *
+ * @return false on EOF, error, timeout or an oversized frame
+ */
+bool recvMessage(Socket& socket, uint32_t& type,
+                 std::vector<std::byte>& payload, int timeout_ms = -1);
@@ -1,17 +1,36 @@
 #pragma once
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <random>
 #include <span>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
+#include "qam_simulator/noise_engine.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+
 /**
  * @brief Class for adding AWGN noise to a signal.
  *
  * This class provides functionality to add Additive White Gaussian Noise (AWGN)
  * to complex-valued symbols. The noise characteristics are determined by the
- * Signal-to-Noise Ratio (SNR).
+ * Signal-to-Noise Ratio (SNR). Samples come from a pluggable NoiseEngine.
+ *
+ * By default the signal power the SNR refers to is measured on every
+ * addNoise() call. With a reference power (e.g. the modulator's
+ * getAveragePower()), sigma is computed once per SNR instead and addNoise()
+ * is a single streaming pass.
+ *
+ * For importance sampling, setImportanceBias() draws the noise with a
+ * variance raised by a fixed factor, so rare decision errors become common,
+ * and likelihoodRatio() gives the weight that turns a count under the
+ * biased channel back into an unbiased estimate for the nominal one.
  */
 class NoiseAdder {
    public:
@@ -20,63 +39,152 @@ class NoiseAdder {
     /**
      * @brief Constructor that initializes the noise generator with a given SNR.
      *
+     * Draws from StdNormalEngine, the historical std::normal_distribution
+     * source, seeded from std::random_device.
+     *
      * @param snr_db Signal-to-Noise Ratio in decibels (dB). This SNR is used to
      *               calculate noise variance relative to the input signal
      * power.
      */
     explicit NoiseAdder(double snr_db)
-        : snr_db_(snr_db), rng_(std::mt19937(std::random_device{}())) {}
+        : NoiseAdder(snr_db, NoiseEngineKind::StdNormal,
+                     std::random_device{}()) {}
 
     /**
-     * @brief Adds AWGN noise to a sequence of input symbols.
+     * @brief Constructor selecting a built-in noise engine and its seed.
      *
-     * The method calculates the power of the input signal, then determines the
-     * required noise variance based on the specified SNR. Gaussian noise is
-     * generated and added to each symbol.
+     * @param snr_db Signal-to-Noise Ratio in decibels (dB).
+     * @param kind Noise engine; NoiseEngineKind::StdNormal reproduces the
+     *             historical std::normal_distribution sequence.
+     * @param seed Seed of the engine's generator.
+     */
+    NoiseAdder(double snr_db, NoiseEngineKind kind, uint64_t seed)
+        : NoiseAdder(snr_db, makeNoiseEngine(kind, seed)) {}
+
+    /**
+     * @brief Constructor taking ownership of a custom noise engine.
      *
-     * @param symbols A span of constant complex symbols (pairs of real and
-     * imaginary values) to which noise will be added.
-     * @return A vector of complex symbols with added noise. Returns an empty
-     * vector if the input span is empty.
+     * @param snr_db Signal-to-Noise Ratio in decibels (dB).
+     * @param engine Engine used to draw the noise samples (not null).
      */
-    std::vector<std::pair<value_type, value_type>> addNoise(
-        std::span<const std::pair<value_type, value_type>> symbols) const {
+    NoiseAdder(double snr_db, std::unique_ptr<NoiseEngine> engine)
+        : snr_db_(snr_db), engine_(std::move(engine)) {
+        if (!engine_) {
+            throw std::invalid_argument("NoiseAdder: engine must not be null");
+        }
+    }
+
+    /**
+     * @brief Constructor with a fixed reference signal power.
+     *
+     * @param snr_db Signal-to-Noise Ratio in decibels (dB).
+     * @param signal_power Mean symbol power E|s|^2 the SNR refers to.
+     * @param kind Noise engine.
+     * @param seed Seed of the engine's generator.
+     */
+    NoiseAdder(double snr_db, double signal_power, NoiseEngineKind kind,
+               uint64_t seed)
+        : NoiseAdder(snr_db, kind, seed) {
+        setSignalPower(signal_power);
+    }
+
+    /**
+     * @brief Adds AWGN noise to symbols in place.
+     *
+     * The method calculates the power of the input signal (unless a
+     * reference power is set), then determines the required noise variance
+     * based on the specified SNR. Gaussian noise is generated and added to
+     * each symbol. Does not allocate.
+     *
+     * @param symbols Symbols as separate I/Q planes, overwritten with the
+     * noisy result.
+     */
+    void addNoise(SampleView symbols) const {
         if (symbols.empty()) {
-            return {};
+            return;
+        }
+        if (signal_power_) {
+            engine_->addTo(symbols, drawnSigma(sigma_));
+            return;
         }
 
         double signal_power = 0.0;
-        for (const auto& symbol : symbols) {
-            double re = static_cast<double>(symbol.first);
-            double im = static_cast<double>(symbol.second);
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            double re = static_cast<double>(symbols.re[i]);
+            double im = static_cast<double>(symbols.im[i]);
             signal_power += re * re + im * im;
         }
         signal_power /= static_cast<double>(symbols.size());
+        addNoise(symbols, signal_power);
+    }
 
-        if (signal_power < 1e-9) {
+    /**
+     * @brief Adds AWGN noise for a given signal power, in place.
+     *
+     * Lets a caller that processes a block in tiles use the power of the
+     * whole block for every tile. Does not allocate.
+     *
+     * @param symbols Symbols as separate I/Q planes, overwritten with the
+     * noisy result.
+     * @param signal_power Mean symbol power E|s|^2 the SNR refers to.
+     */
+    void addNoise(SampleView symbols, double signal_power) const {
+        if (symbols.empty()) {
+            return;
         }
 
-        double snr_linear = std::pow(10.0, snr_db_ / 10.0);
-        double noise_power = (snr_linear == 0)
-                                 ? std::numeric_limits<double>::infinity()
-                                 : (signal_power / snr_linear);
-        double sigma_component_double = std::sqrt(noise_power / 2.0);
-        value_type sigma_component =
-            static_cast<value_type>(sigma_component_double);
-
-        std::normal_distribution<value_type> dist(0.0f, sigma_component);
-
-        std::vector<std::pair<value_type, value_type>> noisy_symbols;
-        noisy_symbols.reserve(symbols.size());
+        engine_->addTo(symbols, drawnSigma(sigmaFor(snr_db_, signal_power)));
+    }
 
-        for (const auto& symbol : symbols) {
-            value_type noise_re = dist(rng_);
-            value_type noise_im = dist(rng_);
-            noisy_symbols.emplace_back(symbol.first + noise_re,
-                                       symbol.second + noise_im);
+    /**
+     * @brief Adds AWGN noise to input symbols, writing into caller storage.
+     *
+     * Does not allocate.
+     *
+     * @param symbols Input symbols as separate I/Q planes.
+     * @param out View receiving the noisy symbols; must have the same size
+     * as @p symbols (it may alias it).
+     * @throws std::invalid_argument if the sizes differ
+     */
+    void addNoise(ConstSampleView symbols, SampleView out) const {
+        if (out.size() != symbols.size()) {
+            throw std::invalid_argument(
+                "NoiseAdder: output size must equal the input size");
         }
+        if (out.re != symbols.re) {
+            std::copy_n(symbols.re, symbols.size(), out.re);
+            std::copy_n(symbols.im, symbols.size(), out.im);
+        }
+        addNoise(out);
+    }
 
-        return noisy_symbols;
+    /**
+     * @brief Adds AWGN noise to a sequence of input symbols.
+     *
+     * @param symbols Input symbols as separate I/Q planes.
+     * @param out Buffer receiving the noisy symbols; resized to fit.
+     */
+    void addNoise(ConstSampleView symbols, SampleBuffer& out) const {
+        out.resize(symbols.size());
+        addNoise(symbols, out.view());
+    }
+
+    /**
+     * @brief Adds AWGN noise to a sequence of input symbols.
+     *
+     * Adapter over the SampleBuffer overload for callers using interleaved
+     * pairs.
+     *
+     * @param symbols A span of constant complex symbols (pairs of real and
+     * imaginary values) to which noise will be added.
+     * @return A vector of complex symbols with added noise. Returns an empty
+     * vector if the input span is empty.
+     */
+    std::vector<std::pair<value_type, value_type>> addNoise(
+        std::span<const std::pair<value_type, value_type>> symbols) const {
+        SampleBuffer noisy;
+        addNoise(SampleBuffer::fromPairs(symbols), noisy);
+        return toPairs(noisy);
     }
 
     /**
@@ -86,7 +194,116 @@ class NoiseAdder {
      */
     double getSNRdb() const { return snr_db_; }
 
+    /**
+     * @brief Change the SNR used by subsequent addNoise() calls.
+     *
+     * @param snr_db New Signal-to-Noise Ratio in decibels (dB).
+     */
+    void setSNRdb(double snr_db) {
+        snr_db_ = snr_db;
+        updateSigma();
+    }
+
+    /**
+     * @brief Set or clear the reference signal power.
+     *
+     * @param signal_power Mean symbol power E|s|^2 the SNR refers to, or
+     * std::nullopt to measure the power on every addNoise() call.
+     */
+    void setSignalPower(std::optional<double> signal_power) {
+        signal_power_ = signal_power;
+        updateSigma();
+    }
+
+    /**
+     * @brief Get the reference signal power, if one is set.
+     */
+    std::optional<double> getSignalPower() const { return signal_power_; }
+
+    /**
+     * @brief Nominal noise standard deviation per I/Q component for the
+     * reference signal power (only meaningful if one is set).
+     *
+     * The SNR's sigma; with an importance bias the noise is drawn wider.
+     */
+    value_type getSigma() const { return sigma_; }
+
+    /**
+     * @brief Draw the noise with its variance raised by @p bias_db dB.
+     *
+     * Samples come from N(0, c^2 sigma^2) per component, c^2 =
+     * 10^(bias_db / 10), instead of N(0, sigma^2): the channel behaves as
+     * if the SNR were bias_db lower, so errors of a high-SNR point are seen
+     * often. Raising the variance rather than shifting the mean needs no
+     * knowledge of which decision boundary is nearest and suits every
+     * order alike. 0 (the default) draws the nominal noise.
+     *
+     * @throws std::invalid_argument if @p bias_db is negative or not finite
+     */
+    void setImportanceBias(double bias_db) {
+        if (!(bias_db >= 0.0) || !std::isfinite(bias_db)) {
+            throw std::invalid_argument(
+                "NoiseAdder: importance bias must be a finite dB >= 0");
+        }
+        importance_bias_db_ = bias_db;
+        importance_scale_ = std::pow(10.0, bias_db / 20.0);
+        updateSigma();
+    }
+
+    /// @brief Importance bias in dB (0 when drawing the nominal noise)
+    double getImportanceBias() const { return importance_bias_db_; }
+
+    /**
+     * @brief Ratio p(n) / q(n) of the nominal to the biased noise density
+     * for one symbol whose noise has energy @p noise_energy = |n|^2.
+     *
+     * Summing errors * likelihoodRatio() over the symbols of a biased run
+     * estimates the errors of the nominal channel without bias. With
+     * c^2 = 10^(bias / 10) it is c^2 exp(-|n|^2 (1 - 1 / c^2) / (2
+     * sigma^2)); exactly 1 without a bias. Needs a reference power.
+     */
+    double likelihoodRatio(double noise_energy) const {
+        return lr_gain_ * std::exp(-noise_energy * lr_decay_);
+    }
+
+    /**
+     * @brief Get the noise engine in use.
+     */
+    NoiseEngine& getEngine() const { return *engine_; }
+
    private:
+    /// @brief Recompute sigma_ and the likelihood ratio terms
+    void updateSigma() {
+        if (!signal_power_) return;
+        sigma_ = sigmaFor(snr_db_, *signal_power_);
+        const double c2 = importance_scale_ * importance_scale_;
+        const double var = static_cast<double>(sigma_) * sigma_;
+        lr_gain_ = c2;
+        lr_decay_ = var > 0.0 ? (1.0 - 1.0 / c2) / (2.0 * var) : 0.0;
+    }
+
+    /// @brief The sigma noise is drawn with for nominal sigma @p sigma
+    value_type drawnSigma(value_type sigma) const {
+        if (importance_bias_db_ == 0.0) return sigma;
+        return static_cast<value_type>(sigma * importance_scale_);
+    }
+
+    /// @brief Per-component sigma for @p signal_power at @p snr_db
+    static value_type sigmaFor(double snr_db, double signal_power) {
+        double snr_linear = std::pow(10.0, snr_db / 10.0);
+        double noise_power = (snr_linear == 0)
+                                 ? std::numeric_limits<double>::infinity()
+                                 : (signal_power / snr_linear);
+        double sigma_component_double = std::sqrt(noise_power / 2.0);
+        return static_cast<value_type>(sigma_component_double);
+    }
+
     double snr_db_;
-    mutable std::mt19937 rng_;
+    std::unique_ptr<NoiseEngine> engine_;
+    std::optional<double> signal_power_;  ///< Reference power, if fixed
+    value_type sigma_ = 0;                ///< sigmaFor(snr_db_, power)
+    double importance_bias_db_ = 0.0;
+    double importance_scale_ = 1.0;  ///< c = 10^(bias / 20)
+    double lr_gain_ = 1.0;           ///< c^2
+    double lr_decay_ = 0.0;          ///< (1 - 1 / c^2) / (2 sigma^2)
 };
\ No newline at end of file
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "qam_simulator/rng.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+#include "qam_simulator/simd.hpp"
+
+/**
+ * @brief Source of zero-mean Gaussian noise for NoiseAdder.
+ *
+ * An engine adds independent N(0, sigma^2) samples to the I and Q planes of
+ * a block of symbols. Implementations differ in speed and in the exact
+ * sample sequence they produce for a given seed.
+ */
+class NoiseEngine {
+   public:
+    using value_type = float;
+
+    virtual ~NoiseEngine() = default;
+
+    /**
+     * @brief Add N(0, sigma^2) noise to both planes of @p symbols.
+     */
+    virtual void addTo(SampleView symbols, value_type sigma) = 0;
+
+    /**
+     * @brief Restart the sample sequence from @p seed.
+     */
+    virtual void seed(uint64_t seed) = 0;
+
+    /**
+     * @brief Short engine name, as accepted by parseNoiseEngineKind().
+     */
+    virtual const char* name() const = 0;
+
+   protected:
+    /// @brief Symbols whose noise is drawn per SIMD add
+    static constexpr size_t kNoiseTile = 256;
+};
+
+/**
+ * @brief Reference engine: std::normal_distribution over std::mt19937.
+ *
+ * Draws re, im, re, im, ... with a fresh distribution per addTo() call,
+ * which reproduces the original NoiseAdder sample sequence bit for bit.
+ */
+class StdNormalEngine final : public NoiseEngine {
+   public:
+    explicit StdNormalEngine(uint64_t seed) : rng_(seedWord(seed)) {}
+
+    void addTo(SampleView symbols, value_type sigma) override {
+        std::normal_distribution<value_type> dist(0.0f, sigma);
+        std::array<value_type, kNoiseTile> noise_re;
+        std::array<value_type, kNoiseTile> noise_im;
+        for (size_t i = 0; i < symbols.size(); i += kNoiseTile) {
+            size_t n = std::min(kNoiseTile, symbols.size() - i);
+            for (size_t k = 0; k < n; ++k) {
+                noise_re[k] = dist(rng_);
+                noise_im[k] = dist(rng_);
+            }
+            simd::addInPlace(symbols.re + i, noise_re.data(), n);
+            simd::addInPlace(symbols.im + i, noise_im.data(), n);
+        }
+    }
+
+    void seed(uint64_t seed) override { rng_.seed(seedWord(seed)); }
+
+    const char* name() const override { return "std"; }
+
+   private:
+    static std::mt19937::result_type seedWord(uint64_t seed) {
+        return static_cast<std::mt19937::result_type>(seed);
+    }
+
+    std::mt19937 rng_;
+};
+
+/**
+ * @brief Fast engine: 128-layer ziggurat (Marsaglia & Tsang) on xoshiro256**.
+ *
+ * About 99% of draws take the fast path of one 64-bit draw, one compare and
+ * one multiply. The layer index and the sample bits come from disjoint parts
+ * of the 64-bit output, which avoids the correlation of the original 32-bit
+ * RNOR. Noise is generated unit-variance into a tile, then scaled and added
+ * with the SIMD kernels.
+ */
+class ZigguratEngine final : public NoiseEngine {
+   public:
+    explicit ZigguratEngine(uint64_t seed) : rng_(seed) {}
+
+    void addTo(SampleView symbols, value_type sigma) override {
+        std::array<value_type, kNoiseTile> noise;
+        for (size_t i = 0; i < symbols.size(); i += kNoiseTile) {
+            size_t n = std::min(kNoiseTile, symbols.size() - i);
+            for (size_t k = 0; k < n; ++k) noise[k] = sigma * next();
+            simd::addInPlace(symbols.re + i, noise.data(), n);
+            for (size_t k = 0; k < n; ++k) noise[k] = sigma * next();
+            simd::addInPlace(symbols.im + i, noise.data(), n);
+        }
+    }
+
+    void seed(uint64_t seed) override { rng_.seed(seed); }
+
+    const char* name() const override { return "ziggurat"; }
+
+    /**
+     * @brief One standard normal sample.
+     */
+    value_type next() {
+        const Tables& t = tables();
+        const uint64_t u = rng_();
+        const int layer = static_cast<int>(u & 0x7F);
+        const int32_t hz = static_cast<int32_t>(u >> 32);
+        if (static_cast<uint32_t>(std::abs(int64_t{hz})) < t.kn[layer]) {
+            return static_cast<value_type>(hz) * t.wn[layer];
+        }
+        return tail(hz, layer);
+    }
+
+   private:
+    static constexpr double kR = 3.442619855899;  ///< Start of the tail
+
+    struct Tables {
+        std::array<uint32_t, 128> kn;
+        std::array<value_type, 128> wn;
+        std::array<value_type, 128> fn;
+    };
+
+    static const Tables& tables() {
+        static const Tables t = [] {
+            Tables out{};
+            const double m1 = 2147483648.0;
+            const double vn = 9.91256303526217e-3;
+            double dn = kR;
+            double tn = dn;
+            const double q = vn / std::exp(-0.5 * dn * dn);
+
+            out.kn[0] = static_cast<uint32_t>((dn / q) * m1);
+            out.kn[1] = 0;
+            out.wn[0] = static_cast<value_type>(q / m1);
+            out.wn[127] = static_cast<value_type>(dn / m1);
+            out.fn[0] = 1.0f;
+            out.fn[127] = static_cast<value_type>(std::exp(-0.5 * dn * dn));
+            for (int i = 126; i >= 1; --i) {
+                dn = std::sqrt(-2.0 * std::log(vn / dn +
+                                               std::exp(-0.5 * dn * dn)));
+                out.kn[i + 1] = static_cast<uint32_t>((dn / tn) * m1);
+                tn = dn;
+                out.fn[i] = static_cast<value_type>(std::exp(-0.5 * dn * dn));
+                out.wn[i] = static_cast<value_type>(dn / m1);
+            }
+            return out;
+        }();
+        return t;
+    }
+
+    /// @brief Slow path: wedge rejection or sampling of the base tail
+    value_type tail(int32_t hz, int layer) {
+        const Tables& t = tables();
+        for (;;) {
+            const value_type x = static_cast<value_type>(hz) * t.wn[layer];
+            if (layer == 0) {
+                value_type tx, ty;
+                do {
+                    tx = -std::log(rng_.uniformOpen()) *
+                         static_cast<value_type>(1.0 / kR);
+                    ty = -std::log(rng_.uniformOpen());
+                } while (ty + ty < tx * tx);
+                const value_type r = static_cast<value_type>(kR) + tx;
+                return hz > 0 ? r : -r;
+            }
+            const value_type f = t.fn[layer];
+            if (f + rng_.uniformOpen() * (t.fn[layer - 1] - f) <
+                std::exp(-0.5f * x * x)) {
+                return x;
+            }
+            const uint64_t u = rng_();
+            layer = static_cast<int>(u & 0x7F);
+            hz = static_cast<int32_t>(u >> 32);
+            if (static_cast<uint32_t>(std::abs(int64_t{hz})) < t.kn[layer]) {
+                return static_cast<value_type>(hz) * t.wn[layer];
+            }
+        }
+    }
+
+    Xoshiro256 rng_;
+};
+
+/**
+ * @brief Table-driven engine: windows of a precomputed pool of standard
+ * normal samples, scaled by sigma with one FMA per sample.
+ *
+ * Each thread builds one pool of kPoolSize ziggurat samples from a fixed
+ * seed on first use, normalized to exactly zero mean and unit variance, so
+ * every thread holds the same pool and results do not depend on the
+ * worker. Per tile, one xoshiro256** draw picks a window offset and a sign
+ * for each of the I and Q planes; the window's samples are then added as
+ * fma(+-sigma, pool[offset + k], x). Noise costs a fraction of a draw per
+ * sample instead of one or more draws.
+ *
+ * Statistical tradeoff: samples repeat. Every sample comes from the
+ * pool's empirical distribution, and only about kPoolSize * p of its
+ * samples lie beyond a decision distance that true noise crosses with
+ * probability p. The BER therefore carries an extra relative error of
+ * about 1 / sqrt(kPoolSize * p) that more bits do not reduce: about 1% at
+ * p = 1e-2 and 10% at p = 1e-4. Beyond the pool's extreme (4.5 sigma)
+ * there are no errors at all. Samples within a window are distinct, but
+ * windows of different tiles overlap with probability about
+ * 2 * kNoiseTile / kPoolSize, so confidence intervals are slightly
+ * optimistic. Use ziggurat for final or low-BER results.
+ */
+class PooledEngine final : public NoiseEngine {
+   public:
+    /// @brief Samples in the pool (a power of two)
+    static constexpr size_t kPoolSize = size_t{1} << 16;
+
+    explicit PooledEngine(uint64_t seed) : rng_(seed), pool_(pool()) {}
+
+    void addTo(SampleView symbols, value_type sigma) override {
+        constexpr uint64_t kMask = kPoolSize - 1;
+        constexpr int kSignBit = std::countr_zero(kPoolSize);
+        for (size_t i = 0; i < symbols.size(); i += kNoiseTile) {
+            const size_t n = std::min(kNoiseTile, symbols.size() - i);
+            const uint64_t u = rng_();
+            const uint64_t v = u >> 32;
+            simd::fmaddInPlace(symbols.re + i, pool_ + (u & kMask),
+                               (u >> kSignBit) & 1 ? -sigma : sigma, n);
+            simd::fmaddInPlace(symbols.im + i, pool_ + (v & kMask),
+                               (v >> kSignBit) & 1 ? -sigma : sigma, n);
+        }
+    }
+
+    void seed(uint64_t seed) override { rng_.seed(seed); }
+
+    const char* name() const override { return "pool"; }
+
+   private:
+    /// @brief Seed of the pool; fixed so every thread builds the same one
+    static constexpr uint64_t kPoolSeed = 0x51414D504F4F4CULL;
+
+    /**
+     * @brief The calling thread's pool, kPoolSize samples followed by a
+     * copy of the first kNoiseTile so no window wraps.
+     */
+    static const value_type* pool() {
+        thread_local const std::vector<value_type> samples = [] {
+            std::vector<value_type> out(kPoolSize + kNoiseTile);
+            ZigguratEngine zig(kPoolSeed);
+            double sum = 0.0;
+            double sum_sq = 0.0;
+            std::vector<double> raw(kPoolSize);
+            for (double& x : raw) {
+                x = zig.next();
+                sum += x;
+                sum_sq += x * x;
+            }
+            const double mean = sum / kPoolSize;
+            const double scale =
+                1.0 / std::sqrt(sum_sq / kPoolSize - mean * mean);
+            for (size_t k = 0; k < kPoolSize; ++k) {
+                out[k] = static_cast<value_type>((raw[k] - mean) * scale);
+            }
+            std::copy_n(out.begin(), kNoiseTile, out.begin() + kPoolSize);
+            return out;
+        }();
+        return samples.data();
+    }
+
+    Xoshiro256 rng_;
+    const value_type* pool_;  ///< Pool of the constructing thread
+};
+
+/// @brief Available noise engines
+enum class NoiseEngineKind { StdNormal, Ziggurat, Pooled };
+
+/**
+ * @brief Create a noise engine of the given kind.
+ */
+inline std::unique_ptr<NoiseEngine> makeNoiseEngine(NoiseEngineKind kind,
+                                                    uint64_t seed) {
+    switch (kind) {
+        case NoiseEngineKind::StdNormal:
+            return std::make_unique<StdNormalEngine>(seed);
+        case NoiseEngineKind::Ziggurat:
+            return std::make_unique<ZigguratEngine>(seed);
+        case NoiseEngineKind::Pooled:
+            return std::make_unique<PooledEngine>(seed);
+    }
+    throw std::invalid_argument("makeNoiseEngine: unknown engine kind");
+}
+
+/**
+ * @brief Parse an engine name ("std", "ziggurat" or "pool").
+ *
+ * @throws std::invalid_argument for unknown names
+ */
+inline NoiseEngineKind parseNoiseEngineKind(std::string_view name) {
+    if (name == "std") return NoiseEngineKind::StdNormal;
+    if (name == "ziggurat") return NoiseEngineKind::Ziggurat;
+    if (name == "pool") return NoiseEngineKind::Pooled;
+    throw std::invalid_argument("Unknown noise engine: " + std::string(name));
+}
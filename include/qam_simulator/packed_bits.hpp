@@ -0,0 +1,238 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "qam_simulator/aligned_allocator.hpp"
+
+/**
+ * @brief Non-owning view of a bitstream packed like PackedBits.
+ *
+ * Behaves like BasicSampleView does for samples: it is cheap to copy and
+ * never owns its words, so the kernels can run on storage carved from an
+ * Arena as well as on a PackedBits.
+ *
+ * @tparam Word uint64_t, const-qualified for read-only views
+ */
+template <typename Word>
+struct BasicPackedBitsView {
+    static constexpr size_t kWordBits = 64;
+
+    Word* data = nullptr;  ///< First word
+    size_t count = 0;      ///< Number of bits
+
+    BasicPackedBitsView() = default;
+    BasicPackedBitsView(Word* data_in, size_t count_in)
+        : data(data_in), count(count_in) {}
+
+    /// @brief Implicit conversion from a mutable to a read-only view
+    template <typename U>
+        requires std::is_same_v<const U, Word>
+    BasicPackedBitsView(const BasicPackedBitsView<U>& other)
+        : data(other.data), count(other.count) {}
+
+    size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+
+    /// @brief Words holding the bits, the last one possibly partial
+    std::span<Word> words() const noexcept {
+        return {data, (count + kWordBits - 1) / kWordBits};
+    }
+
+    /**
+     * @brief Read @p n (1..57) bits starting at bit @p pos, MSB-first.
+     */
+    uint64_t read(size_t pos, int n) const {
+        const size_t w = pos / kWordBits;
+        const int offset = static_cast<int>(pos % kWordBits);
+        uint64_t v = data[w] << offset;
+        if (offset + n > static_cast<int>(kWordBits)) {
+            v |= data[w + 1] >> (kWordBits - offset);
+        }
+        return v >> (kWordBits - n);
+    }
+};
+
+using PackedBitsView = BasicPackedBitsView<uint64_t>;
+using ConstPackedBitsView = BasicPackedBitsView<const uint64_t>;
+
+/**
+ * @brief Bitstream packed 64 bits per word.
+ *
+ * Bits are stored MSB-first: bit i lives in word i / 64 at bit position
+ * 63 - i % 64. This keeps a run of bits in stream order when read as an
+ * integer, so a symbol's bits can be pulled out of a word with two shifts.
+ * Unused bits of the last word are always zero.
+ */
+class PackedBits {
+   public:
+    using word_type = uint64_t;
+    static constexpr size_t kWordBits = 64;
+
+    PackedBits() = default;
+
+    /**
+     * @brief Construct a zeroed stream of @p nbits bits.
+     */
+    explicit PackedBits(size_t nbits)
+        : words_(wordsFor(nbits)), size_(nbits) {}
+
+    /**
+     * @brief Pack a stream of one-bit-per-byte values.
+     */
+    static PackedBits pack(std::span<const uint8_t> bits) {
+        PackedBits packed(bits.size());
+        for (size_t i = 0; i < bits.size(); ++i) {
+            if (bits[i]) packed.words_[i / kWordBits] |= topBit(i);
+        }
+        return packed;
+    }
+
+    /**
+     * @brief Unpack into one bit per byte.
+     *
+     * @param out Output span; its size must equal size()
+     * @throws std::invalid_argument if the sizes differ
+     */
+    void unpack(std::span<uint8_t> out) const {
+        if (out.size() != size_) {
+            throw std::invalid_argument(
+                "PackedBits: unpack size must equal the bit count");
+        }
+        for (size_t i = 0; i < size_; ++i) out[i] = get(i) ? 1 : 0;
+    }
+
+    /**
+     * @brief Resize to @p nbits bits, zeroing the whole stream.
+     *
+     * Only reallocates when the word capacity grows.
+     */
+    void resize(size_t nbits) {
+        words_.assign(wordsFor(nbits), 0);
+        size_ = nbits;
+    }
+
+    /// @brief Number of bits
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    /// @brief Backing words
+    std::span<word_type> words() noexcept { return words_; }
+    std::span<const word_type> words() const noexcept { return words_; }
+
+    bool get(size_t i) const {
+        return (words_[i / kWordBits] & topBit(i)) != 0;
+    }
+
+    void set(size_t i, bool value) {
+        if (value) {
+            words_[i / kWordBits] |= topBit(i);
+        } else {
+            words_[i / kWordBits] &= ~topBit(i);
+        }
+    }
+
+    /**
+     * @brief Read @p count (1..57) bits starting at bit @p pos, MSB-first.
+     */
+    word_type read(size_t pos, int count) const {
+        return view().read(pos, count);
+    }
+
+    PackedBitsView view() noexcept { return {words_.data(), size_}; }
+    ConstPackedBitsView view() const noexcept {
+        return {words_.data(), size_};
+    }
+    operator PackedBitsView() noexcept { return view(); }
+    operator ConstPackedBitsView() const noexcept { return view(); }
+
+    /// @brief Number of words needed for @p nbits bits
+    static constexpr size_t wordsFor(size_t nbits) {
+        return (nbits + kWordBits - 1) / kWordBits;
+    }
+
+   private:
+    static constexpr word_type topBit(size_t i) {
+        return word_type{1} << (kWordBits - 1 - i % kWordBits);
+    }
+
+    std::vector<word_type, AlignedAllocator<word_type>> words_;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Sequential MSB-first writer of small bit groups into packed words.
+ *
+ * The destination words are overwritten, so they need not be zeroed first.
+ * Call flush() after the last put().
+ */
+class PackedBitWriter {
+   public:
+    explicit PackedBitWriter(std::span<uint64_t> words)
+        : out_(words.data()) {}
+
+    /**
+     * @brief Append the low @p count (1..57) bits of @p value.
+     */
+    void put(uint64_t value, int count) {
+        const int free_bits = 64 - fill_;
+        if (count < free_bits) {
+            acc_ |= value << (free_bits - count);
+            fill_ += count;
+            return;
+        }
+        const int spill = count - free_bits;
+        *out_++ = acc_ | (value >> spill);
+        acc_ = spill == 0 ? 0 : value << (64 - spill);
+        fill_ = spill;
+    }
+
+    /// @brief Write out a partially filled last word
+    void flush() {
+        if (fill_ > 0) {
+            *out_++ = acc_;
+            acc_ = 0;
+            fill_ = 0;
+        }
+    }
+
+   private:
+    uint64_t* out_;
+    uint64_t acc_ = 0;
+    int fill_ = 0;
+};
+
+/**
+ * @brief Count differing bits between two runs of packed words.
+ *
+ * Unused trailing bits must be zero in both runs. Only wa.size() words are
+ * compared; @p wb must be at least as long.
+ */
+inline uint64_t count_bit_errors(std::span<const uint64_t> wa,
+                                 std::span<const uint64_t> wb) {
+    uint64_t errors = 0;
+    for (size_t i = 0; i < wa.size(); ++i) {
+        errors += static_cast<uint64_t>(std::popcount(wa[i] ^ wb[i]));
+    }
+    return errors;
+}
+
+/**
+ * @brief Count differing bits between two packed streams (XOR + popcount).
+ *
+ * @throws std::invalid_argument if the streams have different lengths
+ */
+inline uint64_t count_bit_errors(ConstPackedBitsView a,
+                                 ConstPackedBitsView b) {
+    if (a.size() != b.size()) {
+        throw std::invalid_argument(
+            "count_bit_errors: streams must have the same length");
+    }
+    return count_bit_errors(std::span<const uint64_t>(a.words()),
+                            std::span<const uint64_t>(b.words()));
+}
@@ -1,8 +1,55 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "qam_simulator/affinity.hpp"
+#include "qam_simulator/noise_engine.hpp"
+#include "qam_simulator/packed_bits.hpp"
+#include "qam_simulator/rng.hpp"
+#include "qam_simulator/stopping_rule.hpp"
+
+/**
+ * @brief How one block is pushed through modulator, channel and demodulator.
+ */
+enum class BlockKernel {
+    Fused,     ///< Cache-sized tiles through every stage; only errors kept
+    Staged,    ///< One full-block pass per stage, keeping the block's symbols
+    Pipelined  ///< One thread per stage linked by SPSC rings (StagePipeline)
+};
+
+/**
+ * @brief What runs the blocks of a sweep.
+ */
+enum class ComputeBackend {
+    Cpu,  ///< The block kernels on the worker pool
+    Cuda  ///< One fused kernel per batch of blocks on a GPU (gpu_backend.hpp)
+};
+
+/**
+ * @brief Where the results of a sweep are written.
+ */
+enum class ResultsFormat {
+    Csv,     ///< ber_<modulation>.csv files (CsvResultsSink)
+    Binary,  ///< One columnar file (BinaryResultsSink)
+    Both
+};
+
+/**
+ * @brief One block of one SNR point, as addressed by --replay=.
+ */
+struct BlockRef {
+    int levels = 0;        ///< Constellation order M
+    size_t snr_index = 0;  ///< Index of the SNR point in the sweep
+    uint64_t block = 0;    ///< Block index within the point
+};
 
 /**
  * @brief Structure containing simulation parameters.
@@ -41,13 +88,246 @@ struct SimulationParams {
      * @brief Number of iterations performed for each SNR value.
      */
     size_t iterations_per_snr;
+
+    /**
+     * @brief Gaussian noise engine used by the channel (--noise=).
+     */
+    NoiseEngineKind noise_engine = NoiseEngineKind::Ziggurat;
+
+    /**
+     * @brief When each SNR point stops (--target-errors=, --max-rel-ci=,
+     * --max-bits=). The default runs the fixed workload of num_threads x
+     * iterations_per_snr blocks of bits_per_thread bits.
+     */
+    StoppingRule stopping;
+
+    /**
+     * @brief Block kernel (--kernel=). Fused and staged give identical
+     * results; pipelined ignores num_threads and runs the points one after
+     * another on a four-thread chain.
+     */
+    BlockKernel kernel = BlockKernel::Fused;
+
+    /**
+     * @brief Bits a worker holds in memory at a time (--block-bits=).
+     *
+     * Each block of bits_per_thread bits is streamed through reusable
+     * buffers of this size, so peak memory does not depend on
+     * bits_per_thread. Rounded down to whole kernel tiles; 0 disables
+     * streaming.
+     */
+    size_t block_bits = size_t{1} << 20;
+
+    /**
+     * @brief Frames per inter-stage ring of the pipelined kernel
+     * (--ring-depth=).
+     */
+    size_t ring_depth = 4;
+
+    /**
+     * @brief Where the instrumentation JSON goes (--instr-json=); only
+     * used in builds with QAM_ENABLE_INSTRUMENTATION.
+     */
+    std::string instrumentation_json = "qam_instrumentation.json";
+
+    /**
+     * @brief Master seed (--seed=); drawn from std::random_device and
+     * printed when not given.
+     *
+     * Block k of an SNR point always draws the bits and noise keyed by
+     * (seed, M, SNR index, k), and adaptive stopping looks at blocks in
+     * index order, so a run's output is bit-identical for any thread count,
+     * schedule or kernel given the same seed and block budget.
+     */
+    std::optional<uint64_t> seed;
+
+    /**
+     * @brief Run just this block and print its counts (--replay=M:SNR:BLOCK).
+     */
+    std::optional<BlockRef> replay;
+
+    /**
+     * @brief Checkpoint file (--checkpoint=PATH); empty disables
+     * checkpointing.
+     *
+     * Holds the counted blocks of every SNR point. Written every
+     * checkpoint_interval_s seconds and when the sweep ends.
+     */
+    std::string checkpoint_path;
+
+    /**
+     * @brief Seconds between checkpoints (--checkpoint-every=).
+     */
+    double checkpoint_interval_s = 60.0;
+
+    /**
+     * @brief Continue from checkpoint_path if it exists (--resume=PATH,
+     * which also sets checkpoint_path).
+     */
+    bool resume = false;
+
+    /**
+     * @brief Results backend(s) (--results=csv|binary|both).
+     */
+    ResultsFormat results_format = ResultsFormat::Csv;
+
+    /**
+     * @brief File of the binary backend (--results-path=).
+     */
+    std::string results_path = "qam_results.qbr";
+
+    /**
+     * @brief Run as the coordinator of a distributed sweep on this TCP port
+     * (--serve=PORT).
+     *
+     * The coordinator computes nothing itself: it hands (modulation, SNR,
+     * block) units to the workers connected to it, folds their counts in
+     * block order and reports as a local run would, with the same results.
+     */
+    std::optional<uint16_t> serve_port;
+
+    /**
+     * @brief Seconds a worker of the coordinator has to return a batch of
+     * units (--lease=S).
+     *
+     * Units still out when their lease runs out are handed to the other
+     * workers; counts the slow worker sends later are dropped if the block
+     * was already counted. Must exceed the time a worker takes for two
+     * blocks per thread.
+     */
+    double lease_s = 600.0;
+
+    /**
+     * @brief Run as a worker of the coordinator at HOST:PORT
+     * (--connect=HOST:PORT), using num_threads threads.
+     *
+     * The sweep itself (SNR range, workload, seed, engine) comes from the
+     * coordinator; the other positional arguments are ignored.
+     */
+    std::string connect_to;
+
+    /**
+     * @brief Drive every modulation order from one payload per (SNR, block)
+     * (--payload=shared) instead of one per order (--payload=independent).
+     *
+     * bits_per_thread is padded to the least common multiple of the orders'
+     * bits per symbol, and each chunk of a block is generated once and fed
+     * to every modulator, on one pool. Each order keeps its own noise; the
+     * results equal those of a run of each order alone on the shared bit
+     * stream, but differ from an independent-payload run with the same seed.
+     */
+    bool shared_payload = false;
+
+    /**
+     * @brief Constellation orders of the sweep, in output order
+     * (--orders=4,16,64,...).
+     *
+     * Any square order from 4 to 4096 points; each gets its own results
+     * file. With a shared payload the block is padded to whole symbols of
+     * every listed order.
+     */
+    std::vector<int> orders = {4, 16, 64};
+
+    /**
+     * @brief Importance-sampling bias in dB (--importance=DB); 0 is plain
+     * Monte Carlo.
+     *
+     * The channel draws its noise this many dB stronger (see
+     * NoiseAdder::setImportanceBias()) and every errored symbol is weighted
+     * by its likelihood ratio, so points far below the reach of plain
+     * Monte Carlo see errors in every block. The reported BER is the
+     * weighted estimate, with its own variance and CI; Errors stays the raw
+     * count under the biased channel, which --target-errors applies to.
+     * Blocks are counted in order, as for adaptive points. A bias of a few
+     * dB up to the SNR's distance from about BER 1e-2 works well; past
+     * that the weights spread and the variance grows again.
+     */
+    double importance_bias_db = 0.0;
+
+    /**
+     * @brief Device the blocks run on (--backend=cpu|cuda).
+     *
+     * The CUDA backend needs a build with QAM_ENABLE_CUDA. It keeps the
+     * block structure, seeds and in-order stopping of the CPU path, but
+     * draws from Philox streams on the device, so its counts match the CPU
+     * path statistically, not bit for bit. kernel and num_threads do not
+     * apply to it.
+     */
+    ComputeBackend backend = ComputeBackend::Cpu;
+
+    /**
+     * @brief How sweep workers are pinned (--affinity=none|core|node).
+     *
+     * Pinned or not, each worker builds its own scratch buffers, RNG state
+     * and noise engines, so they are first touched, and placed, on the
+     * worker's node. The constellation and slicer tables are read-only
+     * constants shared by all workers.
+     */
+    AffinityMode affinity = AffinityMode::None;
+
+    /**
+     * @brief Seconds between progress lines on stderr (--progress=S); 0
+     * prints none.
+     *
+     * Each line gives the symbols/s and busy threads of the last interval
+     * and how many points have finished (see ProgressReporter). Counts
+     * come from relaxed per-point counters, so workers never wait for a
+     * snapshot. Also the interval of status_file and metrics_port, which
+     * otherwise publish every 10 s.
+     */
+    double progress_interval_s = 0.0;
+
+    /**
+     * @brief File rewritten with the progress metrics every interval
+     * (--status-file=PATH), in the Prometheus text format; empty for none.
+     */
+    std::string status_file;
+
+    /**
+     * @brief Serve the progress metrics over HTTP on this port
+     * (--metrics-port=PORT, 0 picks a free one).
+     */
+    std::optional<uint16_t> metrics_port;
 };
 
+/**
+ * @brief Fills a caller-provided buffer with random bits, one per byte.
+ */
+void generateRandomBits(std::span<uint8_t> out, std::mt19937& rng);
+
+/**
+ * @brief Fills a packed bitstream with random bits.
+ *
+ * Draws the same sequence as the unpacked overload.
+ */
+void generateRandomBits(PackedBits& out, std::mt19937& rng);
+
+/**
+ * @brief Generates a vector of random bits.
+ */
+std::vector<uint8_t> generateRandomBits(size_t n, std::mt19937& rng);
+
+/**
+ * @brief Fills a packed bitstream straight from 64-bit generator output.
+ *
+ * One xoshiro256** draw per 64 bits instead of one 32-bit draw per bit; the
+ * unused bits of the last word are cleared. Takes a view, so a PackedBits
+ * and words carved from an Arena are filled alike.
+ */
+void generateRandomBits(PackedBitsView out, Xoshiro256& rng);
+
+/**
+ * @brief Fills one bit per byte with the same sequence as the packed
+ * xoshiro256** overload.
+ */
+void generateRandomBits(std::span<uint8_t> out, Xoshiro256& rng);
+
 /**
  * @brief Parses command-line arguments and initializes simulation parameters.
  *
  * This function reads the command-line arguments and populates the
- * `SimulationParams` structure with the provided values.
+ * `SimulationParams` structure with the provided values. The six positional
+ * arguments may be followed by options of the form `--name=value`.
  *
  * @param argc Number of command-line arguments.
  * @param argv Array of command-line argument strings.
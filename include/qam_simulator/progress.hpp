@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "qam_simulator/net.hpp"
+
+/**
+ * @file
+ * @brief Live progress of a running sweep (--progress=, --status-file=,
+ * --metrics-port=).
+ *
+ * A reporter thread takes a snapshot of the sweep every interval through a
+ * caller-supplied function that only loads relaxed atomics, so the workers
+ * never wait for it. Each snapshot can go to stderr as one line, to a
+ * status file and to a minimal HTTP endpoint, both in the Prometheus text
+ * exposition format.
+ */
+
+/**
+ * @brief Counts of one (modulation, SNR) point at snapshot time.
+ */
+struct PointProgress {
+    std::string modulation;  ///< Results name of the order ("qpsk", ...)
+    std::string label;       ///< Display name ("QPSK", ...)
+    double snr_db = 0.0;
+    uint64_t errors = 0;     ///< Raw bit errors of the blocks finished so far
+    uint64_t bits = 0;
+    bool finished = false;   ///< Converged or budget spent
+};
+
+/**
+ * @brief State of a sweep at one instant.
+ */
+struct ProgressSnapshot {
+    double elapsed_s = 0.0;  ///< Since the reporter started
+    uint64_t symbols = 0;    ///< Symbols of every finished block
+    double busy_s = 0.0;     ///< Summed block time of all workers
+    std::vector<PointProgress> points;
+};
+
+/**
+ * @brief One line summarizing @p now, with rates taken over the interval
+ * since @p before.
+ *
+ * Gives symbols/s, the mean number of busy threads, the finished points
+ * and the open point with the fewest errors (the one that holds the sweep
+ * up under an error target).
+ */
+std::string formatProgressLine(const ProgressSnapshot& now,
+                               const ProgressSnapshot& before);
+
+/**
+ * @brief @p now in the Prometheus text exposition format, with the
+ * symbols/s of the last interval as a gauge.
+ */
+std::string formatProgressMetrics(const ProgressSnapshot& now,
+                                  double symbols_per_s);
+
+/**
+ * @brief Where the snapshots of a ProgressReporter go.
+ */
+struct ProgressOptions {
+    double interval_s = 10.0;  ///< Seconds between snapshots
+    bool lines = false;        ///< Print formatProgressLine() to stderr
+    /// @brief Rewritten with formatProgressMetrics() every interval, via
+    /// PATH.tmp and a rename; empty for none
+    std::string status_file;
+    /// @brief Serve the metrics over HTTP on this port (0 picks one)
+    std::optional<uint16_t> port;
+};
+
+/**
+ * @brief Publishes a snapshot of a sweep every interval until destroyed.
+ *
+ * @c collect fills the points, symbols and busy time of a snapshot; it is
+ * called from the reporter's threads, at the same time as the workers run,
+ * and must only read state that is safe to read concurrently. The HTTP
+ * endpoint answers every GET with a fresh snapshot. Destruction publishes
+ * a last snapshot with the rates of the whole run, so the status file ends
+ * with the final counts.
+ */
+class ProgressReporter {
+   public:
+    using Collect = std::function<void(ProgressSnapshot&)>;
+
+    /**
+     * @throws std::runtime_error if the metrics port cannot be bound
+     */
+    ProgressReporter(const ProgressOptions& options, Collect collect);
+    ~ProgressReporter();
+
+    ProgressReporter(const ProgressReporter&) = delete;
+    ProgressReporter& operator=(const ProgressReporter&) = delete;
+
+    /// @brief Port of the HTTP endpoint, 0 if there is none
+    uint16_t port() const noexcept;
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Take a snapshot, elapsed time included
+    void take(ProgressSnapshot& out) const;
+    /**
+     * @brief Publish a snapshot to stderr and the status file; the @p final
+     * one gives the rates of the whole run.
+     */
+    void publish(bool final);
+    void loop();
+    void serve();
+
+    ProgressOptions options_;
+    Collect collect_;
+    Clock::time_point start_;
+    ProgressSnapshot first_;  ///< Taken at construction
+    ProgressSnapshot last_;   ///< Last published snapshot
+    /// @brief Symbols/s of the last interval, for the endpoint
+    std::atomic<double> rate_{0.0};
+    std::unique_ptr<Listener> listener_;  ///< Null without an endpoint
+    std::mutex mutex_;  ///< Guards stop_
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+    std::thread thread_;
+    std::thread server_;
+};
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+/// @brief Largest supported constellation order
+inline constexpr int kMaxQamLevels = 4096;
+
+/**
+ * @brief True if @p levels is a supported square order: 4^k points, from
+ * QPSK to kMaxQamLevels.
+ */
+constexpr bool isSquareQamOrder(int levels) {
+    return levels >= 4 && levels <= kMaxQamLevels &&
+           std::has_single_bit(static_cast<unsigned>(levels)) &&
+           std::countr_zero(static_cast<unsigned>(levels)) % 2 == 0;
+}
+
+/// @brief Message of the exception thrown for an unsupported order
+inline constexpr const char* kUnsupportedQamOrder =
+    "only square 4-, 16-, 64-, 256-, 1024- and 4096-QAM are supported";
+
+/**
+ * @brief log2(@p levels), the bits of one symbol of a square order.
+ *
+ * @throws std::invalid_argument if @p levels is not isSquareQamOrder()
+ */
+constexpr int qamBitsPerSymbol(int levels) {
+    if (!isSquareQamOrder(levels)) {
+        throw std::invalid_argument(kUnsupportedQamOrder);
+    }
+    return std::countr_zero(static_cast<unsigned>(levels));
+}
+
+namespace qam_detail {
+
+/**
+ * @brief Unscaled I (imag = false) or Q coordinates of the M points.
+ *
+ * The high half of a label picks the I level and the low half the Q level,
+ * each through a binary-reflected Gray code, so neighbouring points on
+ * either axis differ in exactly one bit. QPSK is the 2 x 2 case.
+ */
+template <int M>
+constexpr std::array<float, M> constellationAxis(bool imag) {
+    std::array<float, M> out{};
+    constexpr int half_bits = std::countr_zero(unsigned{M}) / 2;
+    constexpr int axis_levels = 1 << half_bits;
+    for (int index = 0; index < M; ++index) {
+        int gray = imag ? (index & (axis_levels - 1)) : (index >> half_bits);
+        int level = gray;  // Position of this Gray word on the axis
+        for (int shift = 1; shift < half_bits; shift <<= 1) {
+            level ^= level >> shift;
+        }
+        out[index] = static_cast<float>(2 * level - (axis_levels - 1));
+    }
+    return out;
+}
+
+/// @brief (I level, Q level) -> symbol index, levels counted from the left
+template <int M>
+constexpr std::array<int32_t, M> axisGrid() {
+    constexpr int axis_levels = 1 << (std::countr_zero(unsigned{M}) / 2);
+    constexpr auto re = constellationAxis<M>(false);
+    constexpr auto im = constellationAxis<M>(true);
+    std::array<int32_t, M> grid{};
+    for (int idx = 0; idx < M; ++idx) {
+        int kx = (static_cast<int>(re[idx]) + axis_levels - 1) / 2;
+        int ky = (static_cast<int>(im[idx]) + axis_levels - 1) / 2;
+        grid[kx * axis_levels + ky] = idx;
+    }
+    return grid;
+}
+
+/// @brief Bits of every label, one per byte, MSB first
+template <int M>
+constexpr std::array<uint8_t, M * std::countr_zero(unsigned{M})>
+bitPatterns() {
+    constexpr int bps = std::countr_zero(unsigned{M});
+    std::array<uint8_t, M * bps> out{};
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < bps; ++j) {
+            out[i * bps + j] = static_cast<uint8_t>((i >> (bps - 1 - j)) & 1);
+        }
+    }
+    return out;
+}
+
+/// @brief PAM level values of one axis, from the left
+template <int L>
+constexpr std::array<float, L> axisValues() {
+    std::array<float, L> out{};
+    for (int k = 0; k < L; ++k) out[k] = static_cast<float>(2 * k - (L - 1));
+    return out;
+}
+
+/// @brief Far-away level standing in for "no such neighbour"
+inline constexpr float kNoLevel = 1e18f;
+
+/**
+ * @brief Per-axis soft-decision tables of the bits of a label.
+ *
+ * Bit j depends on axis[j] only (0: I, 1: Q). For every PAM level k of
+ * that axis, entry j * L + k holds: sign, +1 if the bit is 0 at level k
+ * and -1 otherwise; lo / hi, the nearest levels below / above k where the
+ * bit takes the opposite value (+-kNoLevel if none).
+ */
+template <int L, int Bps>
+struct AxisSoftTables {
+    bool separable = false;  ///< Every bit depends on a single axis
+    std::array<int32_t, Bps> axis{};
+    std::array<float, Bps * L> sign{};
+    std::array<float, Bps * L> lo{};
+    std::array<float, Bps * L> hi{};
+};
+
+template <int M>
+constexpr auto axisSoftTables() {
+    constexpr int bps = std::countr_zero(unsigned{M});
+    constexpr int L = 1 << (bps / 2);
+    constexpr auto grid = axisGrid<M>();
+    constexpr auto values = axisValues<L>();
+    auto bit_at = [&](int kx, int ky, int j) {
+        return (grid[kx * L + ky] >> (bps - 1 - j)) & 1;
+    };
+
+    AxisSoftTables<L, bps> t{};
+    for (int j = 0; j < bps; ++j) {
+        bool only_i = true;
+        bool only_q = true;
+        for (int kx = 0; kx < L; ++kx) {
+            for (int ky = 0; ky < L; ++ky) {
+                only_i &= bit_at(kx, ky, j) == bit_at(kx, 0, j);
+                only_q &= bit_at(kx, ky, j) == bit_at(0, ky, j);
+            }
+        }
+        if (!only_i && !only_q) return AxisSoftTables<L, bps>{};
+
+        t.axis[j] = only_i ? 0 : 1;
+        std::array<int, L> value{};
+        for (int k = 0; k < L; ++k) {
+            value[k] = only_i ? bit_at(k, 0, j) : bit_at(0, k, j);
+        }
+        float* row_sign = t.sign.data() + j * L;
+        float* row_lo = t.lo.data() + j * L;
+        float* row_hi = t.hi.data() + j * L;
+        for (int k = 0; k < L; ++k) {
+            row_sign[k] = value[k] == 0 ? 1.0f : -1.0f;
+            row_lo[k] = -kNoLevel;
+            for (int m = k - 1; m >= 0; --m) {
+                if (value[m] != value[k]) {
+                    row_lo[k] = values[m];
+                    break;
+                }
+            }
+            row_hi[k] = kNoLevel;
+            for (int m = k + 1; m < L; ++m) {
+                if (value[m] != value[k]) {
+                    row_hi[k] = values[m];
+                    break;
+                }
+            }
+        }
+    }
+    t.separable = true;
+    return t;
+}
+
+template <int M>
+constexpr float averagePower() {
+    constexpr auto re = constellationAxis<M>(false);
+    constexpr auto im = constellationAxis<M>(true);
+    float sum = 0.0f;
+    for (int i = 0; i < M; ++i) sum += re[i] * re[i] + im[i] * im[i];
+    return sum / M;
+}
+
+}  // namespace qam_detail
+
+/**
+ * @brief Compile-time description of a supported M-QAM constellation.
+ *
+ * Points are unscaled (odd integers on each axis) and indexed by their bit
+ * label, MSB first. All tables are constexpr, so they live in .rodata, are
+ * shared by every modulator and demodulator of the order, and the
+ * fixed-order kernels see the bit count as a constant.
+ *
+ * @tparam M Number of constellation points (4^k, 4 to 4096)
+ */
+template <int M>
+struct QamTraits {
+    static_assert(isSquareQamOrder(M),
+                  "QamTraits: only square 4- to 4096-QAM is supported");
+
+    using value_type = float;
+
+    static constexpr int kLevels = M;
+    static constexpr int kBitsPerSymbol = std::countr_zero(unsigned{M});
+    /// @brief PAM levels per axis
+    static constexpr int kAxisLevels = 1 << (kBitsPerSymbol / 2);
+    static constexpr value_type kAxisMin = -(kAxisLevels - 1);
+    static constexpr value_type kAxisStep = 2.0f;
+
+    alignas(64) static constexpr std::array<value_type, M> kRe =
+        qam_detail::constellationAxis<M>(false);
+    alignas(64) static constexpr std::array<value_type, M> kIm =
+        qam_detail::constellationAxis<M>(true);
+    /// @brief (I level, Q level) -> symbol index, see simd::AxisSlicer
+    alignas(64) static constexpr std::array<int32_t, M> kGrid =
+        qam_detail::axisGrid<M>();
+
+    /// @brief Bits of each label, one per byte, MSB first
+    static constexpr std::array<uint8_t, M * kBitsPerSymbol> kBitPatterns =
+        qam_detail::bitPatterns<M>();
+    /// @brief Value of each PAM level, kAxisMin upwards
+    static constexpr std::array<value_type, kAxisLevels> kAxisValues =
+        qam_detail::axisValues<kAxisLevels>();
+    /// @brief Per-axis soft-decision tables, see qam_detail::AxisSoftTables
+    alignas(64) static constexpr auto kSoft = qam_detail::axisSoftTables<M>();
+
+    static constexpr value_type kAveragePower = qam_detail::averagePower<M>();
+};
+
+/**
+ * @brief Call @p f with the QamTraits of a runtime constellation order.
+ *
+ * This is the bridge from the runtime ModulatorQAM / DemodulatorQAM facades
+ * to the fixed-order kernels: @p f is a generic callable taking the traits
+ * object by value, e.g. [&](auto traits) { using T = decltype(traits); }.
+ *
+ * @throws std::invalid_argument if @p levels is not a supported order
+ */
+template <typename F>
+decltype(auto) withQamOrder(int levels, F&& f) {
+    switch (levels) {
+        case 4:
+            return f(QamTraits<4>{});
+        case 16:
+            return f(QamTraits<16>{});
+        case 64:
+            return f(QamTraits<64>{});
+        case 256:
+            return f(QamTraits<256>{});
+        case 1024:
+            return f(QamTraits<1024>{});
+        case 4096:
+            return f(QamTraits<4096>{});
+    }
+    throw std::invalid_argument(kUnsupportedQamOrder);
+}
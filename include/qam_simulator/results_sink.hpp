@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "qam_simulator/csv_writer.hpp"
+
+/**
+ * @brief Raw outcome of one (modulation, SNR) point.
+ */
+struct ResultRow {
+    std::string modulation;  ///< Short name, e.g. "qam16"
+    int levels = 0;          ///< Constellation order M
+    double snr_db = 0.0;
+    uint64_t errors = 0;
+    uint64_t bits = 0;
+    double ber = 0.0;  ///< errors / bits, or the importance-sampled estimate
+    double ber_variance = 0.0;  ///< Variance of the ber estimate
+    double rel_ci95 = 0.0;      ///< Relative 95% CI half-width of ber
+    /// @brief Compute time of the point: block time summed over workers, or
+    /// the chain's wall time for the pipelined kernel
+    double seconds = 0.0;
+};
+
+/// @brief Run parameters as (key, value) pairs, in insertion order
+using RunMetadata = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * @brief Destination of the results of a sweep.
+ *
+ * Rows arrive point by point as the sweep is reported; finish() is called
+ * once at the end with the parameters of the run.
+ */
+class ResultsSink {
+   public:
+    virtual ~ResultsSink() = default;
+
+    /// @brief Record one point
+    virtual void add(const ResultRow& row) = 0;
+
+    /**
+     * @brief Record the run parameters and flush.
+     *
+     * @return false if the output could not be written
+     */
+    virtual bool finish(const RunMetadata& metadata) = 0;
+};
+
+/**
+ * @brief One ber_<modulation>.csv per modulation, as plotted by
+ * scripts/plot_ber.py, plus the run parameters in run_metadata.csv.
+ *
+ * Columns: SNR_dB, BER, Errors, Bits, RelCI95, Seconds, BERVariance. BER
+ * and BERVariance are written in scientific notation, so that the
+ * importance-sampled estimates of very low BERs keep their digits.
+ */
+class CsvResultsSink final : public ResultsSink {
+   public:
+    /// @param directory Directory the files go to ("" for the current one)
+    explicit CsvResultsSink(std::string directory = "");
+
+    void add(const ResultRow& row) override;
+    bool finish(const RunMetadata& metadata) override;
+
+   private:
+    std::string directory_;
+    std::map<std::string, std::unique_ptr<CsvWriter>> writers_;
+};
+
+/**
+ * @brief Columnar binary results file that can be memory-mapped.
+ *
+ * Layout (little-endian):
+ *
+ *     char     magic[8]       "QAMRES01"
+ *     uint32   version        1
+ *     uint32   metadata_count
+ *     metadata_count x { uint32 key_len, key, uint32 value_len, value }
+ *     (zero padding to a multiple of 8)
+ *     uint64   row_count
+ *     uint32   column_count
+ *     uint32   reserved       0
+ *     column_count x { char name[16], char dtype[8], uint64 offset }
+ *     column data, each column 64-byte aligned at its offset
+ *
+ * name and dtype are NUL-padded; dtype is a NumPy type string ("<f8",
+ * "<i8", "<u8"), so each column loads as np.memmap(path, dtype, 'r',
+ * offset, (row_count,)) without parsing. Columns: levels, snr_db, errors,
+ * bits, ber, rel_ci95, seconds, ber_var. Rows are buffered and written by
+ * finish().
+ */
+class BinaryResultsSink final : public ResultsSink {
+   public:
+    explicit BinaryResultsSink(std::string path);
+
+    void add(const ResultRow& row) override;
+    bool finish(const RunMetadata& metadata) override;
+
+   private:
+    std::string path_;
+    std::vector<int64_t> levels_;
+    std::vector<double> snr_db_;
+    std::vector<uint64_t> errors_;
+    std::vector<uint64_t> bits_;
+    std::vector<double> ber_;
+    std::vector<double> rel_ci95_;
+    std::vector<double> seconds_;
+    std::vector<double> ber_var_;
+};
+
+/**
+ * @brief Forwards every call to several sinks.
+ */
+class TeeResultsSink final : public ResultsSink {
+   public:
+    explicit TeeResultsSink(std::vector<std::unique_ptr<ResultsSink>> sinks);
+
+    void add(const ResultRow& row) override;
+    bool finish(const RunMetadata& metadata) override;
+
+   private:
+    std::vector<std::unique_ptr<ResultsSink>> sinks_;
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+
+/**
+ * @brief SplitMix64 step, used to expand a 64-bit seed into generator state.
+ *
+ * @param state Running state, advanced by one step
+ * @return Next output of the sequence
+ */
+constexpr uint64_t splitmix64(uint64_t& state) noexcept {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief xoshiro256** pseudo-random generator (Blackman & Vigna).
+ *
+ * 256 bits of state, 64-bit outputs, roughly 1 ns per draw. Satisfies
+ * UniformRandomBitGenerator, so it can drive the std distributions as well
+ * as the bulk bit and noise generators in this project.
+ */
+class Xoshiro256 {
+   public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed_value = 0) noexcept {
+        seed(seed_value);
+    }
+
+    /**
+     * @brief Reset the state from a 64-bit seed via SplitMix64.
+     */
+    void seed(uint64_t seed_value) noexcept {
+        uint64_t sm = seed_value;
+        for (auto& word : s_) word = splitmix64(sm);
+    }
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    result_type operator()() noexcept {
+        const uint64_t result = rotl(s_[1] * 5, 7) * 9;
+        const uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = rotl(s_[3], 45);
+        return result;
+    }
+
+    /**
+     * @brief Uniform float in (0, 1], built from the top 24 bits.
+     */
+    float uniformOpen() noexcept {
+        return (static_cast<float>((*this)() >> 40) + 1.0f) * 0x1.0p-24f;
+    }
+
+   private:
+    static constexpr uint64_t rotl(uint64_t x, int k) noexcept {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    uint64_t s_[4];
+};
+
+/**
+ * @brief Identifies the random streams of one SNR point of a sweep.
+ *
+ * Every block of a point draws from streams derived from this key and its
+ * block index alone, so a block's bits and noise do not depend on which
+ * worker runs it, on the thread count or on the order blocks complete in.
+ */
+struct StreamKey {
+    /// @brief payload value selecting the modulation's own bit stream
+    static constexpr uint64_t kOwnPayload = ~uint64_t{0};
+
+    uint64_t master = 0;      ///< Master seed of the run (--seed=)
+    uint64_t modulation = 0;  ///< Constellation order M
+    uint64_t point = 0;       ///< SNR index within the sweep
+    /// @brief Key of the bit stream when several orders share one payload
+    /// (0 for the shared payload, which no order M >= 2 can collide with)
+    uint64_t payload = kOwnPayload;
+};
+
+/**
+ * @brief Seeds of the bit source and the noise engine of one block.
+ */
+struct BlockSeeds {
+    uint64_t bits = 0;
+    uint64_t noise = 0;
+};
+
+/**
+ * @brief Counter-based seeds of block @p block of the point @p key.
+ *
+ * Each key field and the block index are folded in through a SplitMix64
+ * step, so any block can be regenerated on its own without running the
+ * blocks before it. The noise seed is keyed by the modulation; the bit
+ * seed by the payload key if one is set, else by the modulation too.
+ */
+constexpr BlockSeeds blockSeeds(const StreamKey& key, uint64_t block) noexcept {
+    auto stream = [&](uint64_t modulation) {
+        uint64_t state = key.master;
+        for (uint64_t field : {modulation, key.point, block}) {
+            state = splitmix64(state) ^ field;
+        }
+        return state;
+    };
+    uint64_t state = stream(key.modulation);
+    BlockSeeds seeds;
+    seeds.bits = splitmix64(state);
+    seeds.noise = splitmix64(state);
+    if (key.payload != StreamKey::kOwnPayload) {
+        uint64_t shared = stream(key.payload);
+        seeds.bits = splitmix64(shared);
+    }
+    return seeds;
+}
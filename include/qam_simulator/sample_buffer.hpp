@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "qam_simulator/aligned_allocator.hpp"
+
+/**
+ * @brief Non-owning view of complex samples stored as separate I and Q
+ * planes (structure of arrays).
+ *
+ * Behaves like a std::span over samples: it is cheap to copy, can be
+ * sliced with subview(), and never owns the storage it points to.
+ *
+ * @tparam T Component type, const-qualified for read-only views
+ */
+template <typename T>
+struct BasicSampleView {
+    T* re = nullptr;   ///< In-phase plane
+    T* im = nullptr;   ///< Quadrature plane
+    size_t count = 0;  ///< Number of complex samples
+
+    BasicSampleView() = default;
+    BasicSampleView(T* re_in, T* im_in, size_t count_in)
+        : re(re_in), im(im_in), count(count_in) {}
+
+    /// @brief Implicit conversion from a mutable to a read-only view
+    template <typename U>
+        requires std::is_same_v<const U, T>
+    BasicSampleView(const BasicSampleView<U>& other)
+        : re(other.re), im(other.im), count(other.count) {}
+
+    size_t size() const noexcept { return count; }
+    bool empty() const noexcept { return count == 0; }
+
+    std::span<T> real() const { return {re, count}; }
+    std::span<T> imag() const { return {im, count}; }
+
+    /// @brief View of @p n samples starting at @p offset
+    BasicSampleView subview(size_t offset, size_t n) const {
+        return {re + offset, im + offset, n};
+    }
+};
+
+using SampleView = BasicSampleView<float>;
+using ConstSampleView = BasicSampleView<const float>;
+
+/**
+ * @brief Owning buffer of complex samples with 64-byte aligned I and Q
+ * planes.
+ *
+ * This is the sample type passed between ModulatorQAM, NoiseAdder and
+ * DemodulatorQAM. resize() only reallocates when the capacity grows, so a
+ * buffer reused across iterations stops touching the heap after the first
+ * one.
+ */
+class SampleBuffer {
+   public:
+    using value_type = float;
+
+    SampleBuffer() = default;
+
+    /**
+     * @brief Construct a buffer of @p n zero-initialised samples.
+     */
+    explicit SampleBuffer(size_t n) : re_(n), im_(n) {}
+
+    void resize(size_t n) {
+        re_.resize(n);
+        im_.resize(n);
+    }
+
+    size_t size() const noexcept { return re_.size(); }
+    bool empty() const noexcept { return re_.empty(); }
+
+    value_type* re() noexcept { return re_.data(); }
+    value_type* im() noexcept { return im_.data(); }
+    const value_type* re() const noexcept { return re_.data(); }
+    const value_type* im() const noexcept { return im_.data(); }
+
+    SampleView view() noexcept { return {re_.data(), im_.data(), size()}; }
+    ConstSampleView view() const noexcept {
+        return {re_.data(), im_.data(), size()};
+    }
+    operator SampleView() noexcept { return view(); }
+    operator ConstSampleView() const noexcept { return view(); }
+
+    /**
+     * @brief Copy interleaved (real, imaginary) pairs into a new buffer.
+     */
+    static SampleBuffer fromPairs(
+        std::span<const std::pair<value_type, value_type>> pairs) {
+        SampleBuffer buffer(pairs.size());
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            buffer.re_[i] = pairs[i].first;
+            buffer.im_[i] = pairs[i].second;
+        }
+        return buffer;
+    }
+
+   private:
+    std::vector<value_type, AlignedAllocator<value_type>> re_;
+    std::vector<value_type, AlignedAllocator<value_type>> im_;
+};
+
+/**
+ * @brief Copy a sample view into interleaved (real, imaginary) pairs.
+ */
+inline std::vector<std::pair<float, float>> toPairs(ConstSampleView samples) {
+    std::vector<std::pair<float, float>> pairs(samples.size());
+    for (size_t i = 0; i < samples.size(); ++i) {
+        pairs[i] = {samples.re[i], samples.im[i]};
+    }
+    return pairs;
+}
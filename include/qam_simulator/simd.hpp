@@ -0,0 +1,431 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define QAM_SIMD_X86 1
+#else
+#define QAM_SIMD_X86 0
+#endif
+
+/**
+ * @brief Vectorized kernels for the modulate / noise / slice stages.
+ *
+ * Every kernel has a scalar, an AVX2 and an AVX-512 implementation. The
+ * instruction set is selected at runtime from CPUID, so a binary built
+ * without -march=native still uses the widest unit available on the host.
+ * Setting the environment variable QAM_SIMD to "scalar", "avx2" or "avx512"
+ * caps the selection (useful for benchmarking and cross-checking).
+ *
+ * All implementations perform the same floating-point operations in the same
+ * order, so their results are bit-identical.
+ */
+namespace simd {
+
+/// @brief Instruction set used by the kernels
+enum class Isa { Scalar, Avx2, Avx512 };
+
+/**
+ * @brief Human-readable name of an instruction set.
+ */
+inline const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Avx512:
+            return "avx512";
+        case Isa::Avx2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
+
+/**
+ * @brief Widest instruction set supported by the CPU.
+ */
+inline Isa detectIsa() {
+#if QAM_SIMD_X86
+    static const Isa isa = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Isa::Avx512;
+        if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+        return Isa::Scalar;
+    }();
+    return isa;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+/**
+ * @brief Instruction set the kernels dispatch to.
+ *
+ * This is detectIsa(), capped by the QAM_SIMD environment variable if set.
+ * Unknown values of QAM_SIMD are reported on stderr and ignored.
+ */
+inline Isa activeIsa() {
+    static const Isa isa = [] {
+        Isa detected = detectIsa();
+        const char* env = std::getenv("QAM_SIMD");
+        if (env == nullptr) return detected;
+        const std::string_view want(env);
+        Isa requested;
+        if (want == "scalar") {
+            requested = Isa::Scalar;
+        } else if (want == "avx2") {
+            requested = Isa::Avx2;
+        } else if (want == "avx512") {
+            requested = Isa::Avx512;
+        } else {
+            std::cerr << "Ignoring QAM_SIMD=" << want
+                      << " (expected scalar, avx2 or avx512)\n";
+            return detected;
+        }
+        return std::min(requested, detected);
+    }();
+    return isa;
+}
+
+/**
+ * @brief Parameters of a square PAM x PAM slicing grid.
+ *
+ * Both axes share the same levels: axis_min, axis_min + step, ...,
+ * axis_min + (levels - 1) * step. grid maps (I level * levels + Q level)
+ * to the symbol index.
+ */
+struct AxisSlicer {
+    float axis_min;
+    float inv_step;
+    int levels;
+    const int32_t* grid;
+
+    /// @brief Nearest level index on one axis; NaN gives level 0, as in
+    /// the vector slicers
+    int slice(float v) const {
+        float pos = (v - axis_min) * inv_step;
+        // Clamp in float, so the conversion below is always in range
+        if (!(pos >= 0.0f)) pos = 0.0f;
+        const auto top = static_cast<float>(levels - 1);
+        if (pos > top) pos = top;
+        return static_cast<int>(pos + 0.5f);
+    }
+
+    /// @brief Symbol index of the nearest grid point
+    int32_t index(float re, float im) const {
+        return grid[slice(re) * levels + slice(im)];
+    }
+};
+
+namespace detail {
+
+inline void gatherScalar(const int32_t* idx, size_t n, const float* table_re,
+                         const float* table_im, float* re, float* im) {
+    for (size_t i = 0; i < n; ++i) {
+        re[i] = table_re[idx[i]];
+        im[i] = table_im[idx[i]];
+    }
+}
+
+inline void addScalar(float* dst, const float* src, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] += src[i];
+}
+
+inline void fmaddScalar(float* dst, const float* src, float scale,
+                        size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] = std::fma(scale, src[i], dst[i]);
+}
+
+inline void sliceScalar(const float* re, const float* im, size_t n,
+                        const AxisSlicer& s, int32_t* idx) {
+    for (size_t i = 0; i < n; ++i) idx[i] = s.index(re[i], im[i]);
+}
+
+inline void sliceLevelsScalar(const float* v, size_t n, const AxisSlicer& s,
+                              int32_t* k) {
+    for (size_t i = 0; i < n; ++i) k[i] = s.slice(v[i]);
+}
+
+#if QAM_SIMD_X86
+
+__attribute__((target("avx2"))) inline void gatherAvx2(
+    const int32_t* idx, size_t n, const float* table_re,
+    const float* table_im, float* re, float* im) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i vi =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+        _mm256_storeu_ps(re + i, _mm256_i32gather_ps(table_re, vi, 4));
+        _mm256_storeu_ps(im + i, _mm256_i32gather_ps(table_im, vi, 4));
+    }
+    gatherScalar(idx + i, n - i, table_re, table_im, re + i, im + i);
+}
+
+__attribute__((target("avx2"))) inline void addAvx2(float* dst,
+                                                    const float* src,
+                                                    size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 a = _mm256_loadu_ps(dst + i);
+        __m256 b = _mm256_loadu_ps(src + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(a, b));
+    }
+    addScalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2,fma"))) inline void fmaddAvx2(float* dst,
+                                                          const float* src,
+                                                          float scale,
+                                                          size_t n) {
+    const __m256 vs = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 a = _mm256_loadu_ps(dst + i);
+        __m256 b = _mm256_loadu_ps(src + i);
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(vs, b, a));
+    }
+    fmaddScalar(dst + i, src + i, scale, n - i);
+}
+
+__attribute__((target("avx2"))) inline __m256i sliceAxisAvx2(
+    __m256 v, __m256 vmin, __m256 vinv, __m256 vmax) {
+    __m256 pos = _mm256_mul_ps(_mm256_sub_ps(v, vmin), vinv);
+    pos = _mm256_min_ps(_mm256_max_ps(pos, _mm256_setzero_ps()), vmax);
+    return _mm256_cvttps_epi32(_mm256_add_ps(pos, _mm256_set1_ps(0.5f)));
+}
+
+__attribute__((target("avx2"))) inline void sliceAvx2(const float* re,
+                                                      const float* im,
+                                                      size_t n,
+                                                      const AxisSlicer& s,
+                                                      int32_t* idx) {
+    const __m256 vmin = _mm256_set1_ps(s.axis_min);
+    const __m256 vinv = _mm256_set1_ps(s.inv_step);
+    const __m256 vmax = _mm256_set1_ps(static_cast<float>(s.levels - 1));
+    const __m256i levels = _mm256_set1_epi32(s.levels);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i kx = sliceAxisAvx2(_mm256_loadu_ps(re + i), vmin, vinv, vmax);
+        __m256i ky = sliceAxisAvx2(_mm256_loadu_ps(im + i), vmin, vinv, vmax);
+        __m256i cell = _mm256_add_epi32(_mm256_mullo_epi32(kx, levels), ky);
+        __m256i v = _mm256_i32gather_epi32(s.grid, cell, 4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(idx + i), v);
+    }
+    sliceScalar(re + i, im + i, n - i, s, idx + i);
+}
+
+__attribute__((target("avx2"))) inline void sliceLevelsAvx2(
+    const float* v, size_t n, const AxisSlicer& s, int32_t* k) {
+    const __m256 vmin = _mm256_set1_ps(s.axis_min);
+    const __m256 vinv = _mm256_set1_ps(s.inv_step);
+    const __m256 vmax = _mm256_set1_ps(static_cast<float>(s.levels - 1));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i kv = sliceAxisAvx2(_mm256_loadu_ps(v + i), vmin, vinv, vmax);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(k + i), kv);
+    }
+    sliceLevelsScalar(v + i, n - i, s, k + i);
+}
+
+__attribute__((target("avx512f"))) inline void gatherAvx512(
+    const int32_t* idx, size_t n, const float* table_re,
+    const float* table_im, float* re, float* im) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i vi = _mm512_loadu_si512(idx + i);
+        _mm512_storeu_ps(re + i, _mm512_i32gather_ps(vi, table_re, 4));
+        _mm512_storeu_ps(im + i, _mm512_i32gather_ps(vi, table_im, 4));
+    }
+    gatherScalar(idx + i, n - i, table_re, table_im, re + i, im + i);
+}
+
+__attribute__((target("avx512f"))) inline void addAvx512(float* dst,
+                                                        const float* src,
+                                                        size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 a = _mm512_loadu_ps(dst + i);
+        __m512 b = _mm512_loadu_ps(src + i);
+        _mm512_storeu_ps(dst + i, _mm512_add_ps(a, b));
+    }
+    addScalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx512f"))) inline void fmaddAvx512(float* dst,
+                                                          const float* src,
+                                                          float scale,
+                                                          size_t n) {
+    const __m512 vs = _mm512_set1_ps(scale);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 a = _mm512_loadu_ps(dst + i);
+        __m512 b = _mm512_loadu_ps(src + i);
+        _mm512_storeu_ps(dst + i, _mm512_fmadd_ps(vs, b, a));
+    }
+    fmaddScalar(dst + i, src + i, scale, n - i);
+}
+
+__attribute__((target("avx512f"))) inline __m512i sliceAxisAvx512(
+    __m512 v, __m512 vmin, __m512 vinv, __m512 vmax) {
+    __m512 pos = _mm512_mul_ps(_mm512_sub_ps(v, vmin), vinv);
+    pos = _mm512_min_ps(_mm512_max_ps(pos, _mm512_setzero_ps()), vmax);
+    return _mm512_cvttps_epi32(_mm512_add_ps(pos, _mm512_set1_ps(0.5f)));
+}
+
+__attribute__((target("avx512f"))) inline void sliceAvx512(
+    const float* re, const float* im, size_t n, const AxisSlicer& s,
+    int32_t* idx) {
+    const __m512 vmin = _mm512_set1_ps(s.axis_min);
+    const __m512 vinv = _mm512_set1_ps(s.inv_step);
+    const __m512 vmax = _mm512_set1_ps(static_cast<float>(s.levels - 1));
+    const __m512i levels = _mm512_set1_epi32(s.levels);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i kx =
+            sliceAxisAvx512(_mm512_loadu_ps(re + i), vmin, vinv, vmax);
+        __m512i ky =
+            sliceAxisAvx512(_mm512_loadu_ps(im + i), vmin, vinv, vmax);
+        __m512i cell = _mm512_add_epi32(_mm512_mullo_epi32(kx, levels), ky);
+        __m512i v = _mm512_i32gather_epi32(cell, s.grid, 4);
+        _mm512_storeu_si512(idx + i, v);
+    }
+    sliceScalar(re + i, im + i, n - i, s, idx + i);
+}
+
+__attribute__((target("avx512f"))) inline void sliceLevelsAvx512(
+    const float* v, size_t n, const AxisSlicer& s, int32_t* k) {
+    const __m512 vmin = _mm512_set1_ps(s.axis_min);
+    const __m512 vinv = _mm512_set1_ps(s.inv_step);
+    const __m512 vmax = _mm512_set1_ps(static_cast<float>(s.levels - 1));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i kv =
+            sliceAxisAvx512(_mm512_loadu_ps(v + i), vmin, vinv, vmax);
+        _mm512_storeu_si512(k + i, kv);
+    }
+    sliceLevelsScalar(v + i, n - i, s, k + i);
+}
+
+#endif  // QAM_SIMD_X86
+
+}  // namespace detail
+
+/**
+ * @brief Gathers constellation points by index into separate I/Q planes.
+ *
+ * @param idx Symbol indices
+ * @param n Number of symbols
+ * @param table_re In-phase component of each constellation point
+ * @param table_im Quadrature component of each constellation point
+ * @param re Output in-phase plane of n floats
+ * @param im Output quadrature plane of n floats
+ */
+inline void gather(const int32_t* idx, size_t n, const float* table_re,
+                   const float* table_im, float* re, float* im) {
+#if QAM_SIMD_X86
+    switch (activeIsa()) {
+        case Isa::Avx512:
+            return detail::gatherAvx512(idx, n, table_re, table_im, re, im);
+        case Isa::Avx2:
+            return detail::gatherAvx2(idx, n, table_re, table_im, re, im);
+        default:
+            break;
+    }
+#endif
+    detail::gatherScalar(idx, n, table_re, table_im, re, im);
+}
+
+/**
+ * @brief Element-wise dst[i] += src[i].
+ */
+inline void addInPlace(float* dst, const float* src, size_t n) {
+#if QAM_SIMD_X86
+    switch (activeIsa()) {
+        case Isa::Avx512:
+            return detail::addAvx512(dst, src, n);
+        case Isa::Avx2:
+            return detail::addAvx2(dst, src, n);
+        default:
+            break;
+    }
+#endif
+    detail::addScalar(dst, src, n);
+}
+
+/**
+ * @brief Element-wise dst[i] = fma(scale, src[i], dst[i]), rounded once.
+ *
+ * The AVX2 path also needs FMA3; CPUs with AVX2 but without it take the
+ * scalar path, which gives the same results.
+ */
+inline void fmaddInPlace(float* dst, const float* src, float scale,
+                         size_t n) {
+#if QAM_SIMD_X86
+    switch (activeIsa()) {
+        case Isa::Avx512:
+            return detail::fmaddAvx512(dst, src, scale, n);
+        case Isa::Avx2:
+            if (__builtin_cpu_supports("fma")) {
+                return detail::fmaddAvx2(dst, src, scale, n);
+            }
+            break;
+        default:
+            break;
+    }
+#endif
+    detail::fmaddScalar(dst, src, scale, n);
+}
+
+/**
+ * @brief Slices samples given as I/Q planes to symbol indices.
+ *
+ * @param re In-phase plane
+ * @param im Quadrature plane
+ * @param n Number of symbols
+ * @param slicer Grid description
+ * @param idx Output buffer of n symbol indices
+ */
+inline void slice(const float* re, const float* im, size_t n,
+                  const AxisSlicer& slicer, int32_t* idx) {
+#if QAM_SIMD_X86
+    switch (activeIsa()) {
+        case Isa::Avx512:
+            return detail::sliceAvx512(re, im, n, slicer, idx);
+        case Isa::Avx2:
+            return detail::sliceAvx2(re, im, n, slicer, idx);
+        default:
+            break;
+    }
+#endif
+    detail::sliceScalar(re, im, n, slicer, idx);
+}
+
+/**
+ * @brief Slices samples of one axis to PAM level indices.
+ *
+ * @param v Samples of one plane (I or Q)
+ * @param n Number of samples
+ * @param slicer Grid description (grid is not used)
+ * @param k Output buffer of n level indices in [0, slicer.levels)
+ */
+inline void sliceLevels(const float* v, size_t n, const AxisSlicer& slicer,
+                        int32_t* k) {
+#if QAM_SIMD_X86
+    switch (activeIsa()) {
+        case Isa::Avx512:
+            return detail::sliceLevelsAvx512(v, n, slicer, k);
+        case Isa::Avx2:
+            return detail::sliceLevelsAvx2(v, n, slicer, k);
+        default:
+            break;
+    }
+#endif
+    detail::sliceLevelsScalar(v, n, slicer, k);
+}
+
+}  // namespace simd
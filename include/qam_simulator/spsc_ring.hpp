@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free single-producer / single-consumer queue.
+ *
+ * Exactly one thread may call tryPush() and exactly one (other) thread may
+ * call tryPop(). The capacity is rounded up to a power of two. Head and
+ * tail sit on separate cache lines, and each side caches the other's index
+ * so the shared line is only read when the queue looks full or empty.
+ * Storage is allocated once at construction.
+ */
+template <typename T>
+class SpscRing {
+   public:
+    /**
+     * @brief Create a ring holding at least @p capacity elements.
+     *
+     * @throws std::invalid_argument if @p capacity is zero
+     */
+    explicit SpscRing(size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("SpscRing: capacity must be positive");
+        }
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Append @p value unless the ring is full (producer only).
+     *
+     * @return false if the ring was full; @p value is left untouched
+     */
+    bool tryPush(T& value) {
+        const size_t tail = tail_.value.load(std::memory_order_relaxed);
+        if (tail - head_cache_ > mask_) {
+            head_cache_ = head_.value.load(std::memory_order_acquire);
+            if (tail - head_cache_ > mask_) return false;
+        }
+        slots_[tail & mask_] = std::move(value);
+        tail_.value.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest element into @p out unless the ring is empty
+     * (consumer only).
+     */
+    bool tryPop(T& out) {
+        const size_t head = head_.value.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.value.load(std::memory_order_acquire);
+            if (head == tail_cache_) return false;
+        }
+        out = std::move(slots_[head & mask_]);
+        head_.value.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Number of slots
+    size_t capacity() const noexcept { return mask_ + 1; }
+
+   private:
+    struct alignas(64) Index {
+        std::atomic<size_t> value{0};
+    };
+
+    std::vector<T> slots_;
+    size_t mask_ = 0;
+
+    Index head_;  ///< Next slot to pop, written by the consumer
+    alignas(64) size_t tail_cache_ = 0;  ///< Consumer's copy of tail_
+    Index tail_;  ///< Next slot to push, written by the producer
+    alignas(64) size_t head_cache_ = 0;  ///< Producer's copy of head_
+};
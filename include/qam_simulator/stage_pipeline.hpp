@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "qam_simulator/demodulator_qam.hpp"
+#include "qam_simulator/modulator_qam.hpp"
+#include "qam_simulator/noise_engine.hpp"
+#include "qam_simulator/packed_bits.hpp"
+#include "qam_simulator/rng.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+#include "qam_simulator/spsc_ring.hpp"
+#include "qam_simulator/stopping_rule.hpp"
+
+/**
+ * @brief Counters of one stage of a StagePipeline run.
+ *
+ * Times are wall-clock seconds of the stage's thread. starved_s is time
+ * spent waiting for input from upstream; blocked_s is time spent waiting
+ * for room in the downstream ring, i.e. backpressure.
+ */
+struct StageStats {
+    const char* name = "";
+    uint64_t frames = 0;
+    uint64_t bits = 0;
+    double busy_s = 0.0;
+    double starved_s = 0.0;
+    double blocked_s = 0.0;
+
+    StageStats& operator+=(const StageStats& other);
+};
+
+/**
+ * @brief Outcome of one StagePipeline run.
+ */
+struct StagePipelineResult {
+    /// @brief Stages in chain order
+    enum Stage { Generate, Modulate, Channel, Demodulate, kStageCount };
+
+    uint64_t errors = 0;
+    uint64_t bits = 0;
+    double wall_s = 0.0;
+    std::array<StageStats, kStageCount> stages;
+};
+
+/**
+ * @brief Stage-parallel transmit/receive chain modelling a real-time link.
+ *
+ * Bit generation, modulation, channel and demodulation (with error
+ * counting) each run on their own thread. Stages hand frames to each other
+ * through lock-free SPSC rings of a fixed depth, and finished frames go back
+ * to the generator through a free ring, so no frame buffer is allocated
+ * while running. A slow stage shows up as starvation downstream and as
+ * blocked time upstream.
+ */
+class StagePipeline {
+   public:
+    /**
+     * @brief Build the chain and its frame pool.
+     *
+     * @param mod Modulator (must outlive the pipeline)
+     * @param demod Demodulator of the same order (must outlive the pipeline)
+     * @param noise Noise engine kind of the channel stage
+     * @param frame_bits Bits per frame (a multiple of BitsPerSymbol)
+     * @param depth Frames each inter-stage ring can hold
+     * @throws std::invalid_argument on a bad frame size or depth
+     */
+    StagePipeline(const ModulatorQAM& mod, const DemodulatorQAM& demod,
+                  NoiseEngineKind noise, size_t frame_bits, size_t depth);
+
+    StagePipeline(const StagePipeline&) = delete;
+    StagePipeline& operator=(const StagePipeline&) = delete;
+
+    /**
+     * @brief Push up to @p max_blocks blocks of @p block_bits bits through
+     * the chain at one SNR.
+     *
+     * Block k draws its bits and noise from blockSeeds(key, k), split into
+     * frames the same way the sweep kernels split a block into chunks, so
+     * the counts equal those of the fused and staged kernels. The stopping
+     * rule is evaluated after each whole block, in block order; frames
+     * already in flight when it holds are drained but not counted.
+     *
+     * @param snr_db SNR of the channel stage
+     * @param block_bits Bits per block (a multiple of BitsPerSymbol)
+     * @param max_blocks Block budget of the run
+     * @param stopping Early-stopping rule (may be non-adaptive)
+     * @param key Streams of this SNR point
+     */
+    StagePipelineResult run(double snr_db, size_t block_bits,
+                            uint64_t max_blocks, const StoppingRule& stopping,
+                            const StreamKey& key);
+
+   private:
+    struct Frame {
+        PackedBits bits;
+        SampleBuffer samples;
+        PackedBits decided;
+        uint64_t block = 0;        ///< Block the frame belongs to
+        bool block_start = false;  ///< First frame of its block
+        bool block_end = false;    ///< Last frame of its block
+    };
+
+    const ModulatorQAM& mod_;
+    const DemodulatorQAM& demod_;
+    NoiseEngineKind noise_kind_;
+    size_t frame_bits_;
+
+    std::vector<Frame> frames_;
+    SpscRing<Frame*> free_;        ///< Demodulate -> Generate
+    SpscRing<Frame*> generated_;   ///< Generate -> Modulate
+    SpscRing<Frame*> modulated_;   ///< Modulate -> Channel
+    SpscRing<Frame*> received_;    ///< Channel -> Demodulate
+    std::atomic<bool> stop_{false};  ///< Set once the stopping rule holds
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Relative half-width of the 95% confidence interval of a BER
+ * estimate.
+ *
+ * Uses the normal approximation to the binomial,
+ * 1.96 * sqrt(p (1 - p) / n) / p with p = errors / bits.
+ *
+ * @return The relative half-width, or +infinity when no error was seen.
+ */
+inline double ber_rel_ci95(uint64_t errors, uint64_t bits) {
+    if (errors == 0 || bits == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    const double n = static_cast<double>(bits);
+    const double p = static_cast<double>(errors) / n;
+    return 1.96 * std::sqrt(p * (1.0 - p) / n) / p;
+}
+
+/**
+ * @brief Variance of an importance-sampled BER estimate.
+ *
+ * Each symbol contributes e * w, its bit errors times the likelihood ratio
+ * of its noise. Symbols are independent but their bits are not, so the
+ * sample variance is taken over symbols:
+ * Var = (sum (e w)^2 - (sum e w)^2 / n) / bits^2 with n = bits / bps
+ * symbols, for the estimate (sum e w) / bits.
+ *
+ * @param weighted Sum of e * w
+ * @param weighted_sq Sum of (e * w)^2
+ */
+inline double weighted_ber_variance(double weighted, double weighted_sq,
+                                    uint64_t bits, int bits_per_symbol) {
+    if (bits == 0) return std::numeric_limits<double>::infinity();
+    const double b = static_cast<double>(bits);
+    const double n = b / bits_per_symbol;
+    return std::max(0.0, weighted_sq - weighted * weighted / n) / (b * b);
+}
+
+/**
+ * @brief Relative half-width of the 95% CI of an importance-sampled BER
+ * estimate (see weighted_ber_variance()).
+ *
+ * @return The relative half-width, or +infinity when no error was seen.
+ */
+inline double weighted_rel_ci95(double weighted, double weighted_sq,
+                                uint64_t bits, int bits_per_symbol) {
+    if (!(weighted > 0.0) || bits == 0) {
+        return std::numeric_limits<double>::infinity();
+    }
+    const double ber = weighted / static_cast<double>(bits);
+    return 1.96 *
+           std::sqrt(weighted_ber_variance(weighted, weighted_sq, bits,
+                                           bits_per_symbol)) /
+           ber;
+}
+
+/**
+ * @brief Per-SNR-point Monte-Carlo stopping rule.
+ *
+ * A point stops as soon as any enabled criterion holds: enough errors were
+ * observed, the relative 95% CI is narrow enough, or the bit budget is
+ * spent. With every criterion disabled a point simply runs its fixed
+ * workload.
+ */
+struct StoppingRule {
+    /// @brief Stop once this many errors were seen (0 = disabled)
+    uint64_t target_errors = 0;
+
+    /// @brief Stop once ber_rel_ci95() drops to this value (0 = disabled)
+    double max_rel_ci = 0.0;
+
+    /// @brief Bit budget per point (0 = the fixed workload)
+    uint64_t max_bits = 0;
+
+    /// @brief True if an error- or CI-based criterion is enabled
+    bool adaptive() const noexcept {
+        return target_errors > 0 || max_rel_ci > 0.0;
+    }
+
+    /// @brief True if a point with these counts has converged
+    bool converged(uint64_t errors, uint64_t bits) const {
+        return convergedAt(errors, ber_rel_ci95(errors, bits));
+    }
+
+    /**
+     * @brief True if a point with @p errors observed errors and an estimate
+     * of relative CI @p rel_ci95 has converged.
+     *
+     * For estimators other than errors / bits, such as importance sampling.
+     */
+    bool convergedAt(uint64_t errors, double rel_ci95) const {
+        if (target_errors > 0 && errors >= target_errors) return true;
+        if (max_rel_ci > 0.0 && rel_ci95 <= max_rel_ci) return true;
+        return false;
+    }
+};
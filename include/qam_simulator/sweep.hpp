@@ -0,0 +1,572 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "qam_simulator/arena.hpp"
+#include "qam_simulator/checkpoint.hpp"
+#include "qam_simulator/demodulator_qam.hpp"
+#include "qam_simulator/modulator_qam.hpp"
+#include "qam_simulator/noise.hpp"
+#include "qam_simulator/packed_bits.hpp"
+#include "qam_simulator/pipeline.hpp"
+#include "qam_simulator/progress.hpp"
+#include "qam_simulator/qam_traits.hpp"
+#include "qam_simulator/rng.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+#include "qam_simulator/stage_pipeline.hpp"
+#include "qam_simulator/stopping_rule.hpp"
+
+/**
+ * @file
+ * @brief Jobs, block kernels and bookkeeping of a sweep, shared by the
+ * local scheduler (qam_simulator.cpp), the distributed mode
+ * (distributed.hpp) and the GPU host side (gpu_backend.hpp).
+ *
+ * A sweep is one ModulationJob per constellation order. Any runner claims
+ * blocks with reserveBlock(), computes them (run_block() on the CPU) and
+ * hands the counts to commitBlock() or the per-worker counters, so every
+ * runner gives the totals of the same seed and budget.
+ */
+
+/**
+ * @brief A modulation order of the sweep.
+ */
+struct Order {
+    int levels;
+    size_t bits_per_symbol;
+    const char* name;
+    const char* label;
+};
+
+inline constexpr Order kOrders[] = {{4, 2, "qpsk", "QPSK"},
+                                    {16, 4, "qam16", "16-QAM"},
+                                    {64, 6, "qam64", "64-QAM"},
+                                    {256, 8, "qam256", "256-QAM"},
+                                    {1024, 10, "qam1024", "1024-QAM"},
+                                    {4096, 12, "qam4096", "4096-QAM"}};
+
+/// @brief The entry of kOrders with @p levels points, or nullptr
+const Order* find_order(int levels);
+
+/// @brief Least common multiple of the bits per symbol of p.orders
+size_t shared_payload_unit(const SimulationParams& p);
+
+/**
+ * @brief Bits of the payload that make whole symbols: those of one symbol,
+ * or of every order when the payload is shared.
+ */
+size_t payload_unit(const SimulationParams& p, size_t bits_per_symbol);
+
+/**
+ * @brief Errors and bits of one finished block.
+ *
+ * With importance sampling, weighted and weighted_sq sum e * w and
+ * (e * w)^2 over the block's symbols, for e bit errors of a symbol and w
+ * the likelihood ratio of its noise (see weighted_ber_variance()).
+ */
+struct BlockTally {
+    uint64_t errors = 0;
+    uint64_t bits = 0;
+    double weighted = 0.0;
+    double weighted_sq = 0.0;
+};
+
+/**
+ * @brief Finished blocks of one SNR point, folded in block order.
+ *
+ * Blocks finish in any order. A block is counted only once every block
+ * before it has been, and the stopping rule is checked after each one, so
+ * an adaptive point stops after the same block whatever the schedule.
+ */
+struct PointLedger {
+    std::mutex mutex;
+    std::map<uint64_t, BlockTally> pending;  ///< Finished, not yet counted
+    uint64_t next = 0;                       ///< Blocks counted so far
+    uint64_t errors = 0;
+    uint64_t bits = 0;
+    double weighted = 0.0;  ///< See BlockTally
+    double weighted_sq = 0.0;
+};
+
+/**
+ * @brief One modulation order of a sweep and its per-SNR accumulators.
+ */
+struct ModulationJob {
+    ModulationJob(int levels_in, std::string name_in,
+                  const SimulationParams& params_in)
+        : levels(levels_in),
+          name(std::move(name_in)),
+          params(params_in),
+          mod(levels_in),
+          demod(levels_in),
+          payload_bits(payload_unit(params_in, mod.getBitsPerSymbol())) {
+        for (double snr = params.snr_start; snr <= params.snr_end;
+             snr += params.snr_step)
+            snrs.push_back(snr);
+        errors.assign(snrs.size(), 0);
+        bits.assign(snrs.size(), 0);
+        weighted.assign(snrs.size(), 0.0);
+        weighted_sq.assign(snrs.size(), 0.0);
+        issued = std::vector<std::atomic<uint64_t>>(snrs.size());
+        converged = std::vector<std::atomic<bool>>(snrs.size());
+        ledgers = std::vector<PointLedger>(snrs.size());
+        busy_ns = std::vector<std::atomic<uint64_t>>(snrs.size());
+        done_errors = std::vector<std::atomic<uint64_t>>(snrs.size());
+        done_bits = std::vector<std::atomic<uint64_t>>(snrs.size());
+        // Weighted sums are doubles, so they too are folded in block order
+        ordered = params.stopping.adaptive() ||
+                  !params.checkpoint_path.empty() || params.serve_port ||
+                  importance() || params.backend == ComputeBackend::Cuda;
+
+        const uint64_t fixed_blocks =
+            static_cast<uint64_t>(std::max(1, params.num_threads)) *
+            params.iterations_per_snr;
+        const uint64_t block_bits = std::max<uint64_t>(
+            1, params.bits_per_thread);
+        max_blocks = params.stopping.max_bits > 0
+                         ? (params.stopping.max_bits + block_bits - 1) /
+                               block_bits
+                         : fixed_blocks;
+    }
+
+    /**
+     * @brief Claim the next block of an SNR point.
+     *
+     * @param block Receives the index of the claimed block
+     * @return false if the point has converged or its budget is spent.
+     */
+    bool reserveBlock(size_t snr_index, uint64_t& block) {
+        if (converged[snr_index].load(std::memory_order_relaxed)) return false;
+        if (issued[snr_index].load(std::memory_order_relaxed) >= max_blocks) {
+            return false;
+        }
+        block = issued[snr_index].fetch_add(1);
+        return block < max_blocks;
+    }
+
+    /**
+     * @brief Streams of an SNR point.
+     */
+    StreamKey streamKey(size_t snr_index) const {
+        StreamKey key{params.seed.value_or(0), static_cast<uint64_t>(levels),
+                      snr_index};
+        if (params.shared_payload) key.payload = 0;
+        return key;
+    }
+
+    /// @brief True if the channel is importance sampled
+    bool importance() const { return params.importance_bias_db > 0.0; }
+
+    /**
+     * @brief Relative 95% CI half-width of a point with these totals: of
+     * errors / bits, or of the weighted estimate with importance sampling.
+     */
+    double relCi95(uint64_t point_errors, uint64_t point_bits,
+                   double point_weighted, double point_weighted_sq) const {
+        if (!importance()) return ber_rel_ci95(point_errors, point_bits);
+        return weighted_rel_ci95(point_weighted, point_weighted_sq,
+                                 point_bits, mod.getBitsPerSymbol());
+    }
+
+    /**
+     * @brief Add a finished block to the live counts of an SNR point.
+     *
+     * Every finished block is added, counted or not, so the counts may run
+     * ahead of the totals. Relaxed, and read without locks (see
+     * collect_progress()).
+     */
+    void recordProgress(size_t snr_index, uint64_t block_errors,
+                        uint64_t block_bits) {
+        done_errors[snr_index].fetch_add(block_errors,
+                                         std::memory_order_relaxed);
+        done_bits[snr_index].fetch_add(block_bits, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Count a finished block of an ordered point in block order and
+     * mark the point converged once its stopping rule is met.
+     *
+     * Blocks past the one the rule held at, and blocks already counted
+     * (a shared-payload sweep resumes every order from the least advanced
+     * one), are dropped.
+     */
+    void commitBlock(size_t snr_index, uint64_t block, BlockTally tally) {
+        PointLedger& ledger = ledgers[snr_index];
+        std::lock_guard<std::mutex> lock(ledger.mutex);
+        if (converged[snr_index].load(std::memory_order_relaxed)) return;
+        if (block < ledger.next) return;
+        ledger.pending.emplace(block, tally);
+        auto it = ledger.pending.begin();
+        while (it != ledger.pending.end() && it->first == ledger.next) {
+            ledger.errors += it->second.errors;
+            ledger.bits += it->second.bits;
+            ledger.weighted += it->second.weighted;
+            ledger.weighted_sq += it->second.weighted_sq;
+            ++ledger.next;
+            it = ledger.pending.erase(it);
+            if (params.stopping.convergedAt(
+                    ledger.errors,
+                    relCi95(ledger.errors, ledger.bits, ledger.weighted,
+                            ledger.weighted_sq))) {
+                converged[snr_index] = true;
+                ledger.pending.clear();
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Blocks counted so far at an SNR point, in checkpoint form.
+     */
+    PointCheckpoint savePoint(size_t snr_index) {
+        PointLedger& ledger = ledgers[snr_index];
+        std::lock_guard<std::mutex> lock(ledger.mutex);
+        return {ledger.next, ledger.errors, ledger.bits, ledger.weighted,
+                ledger.weighted_sq};
+    }
+
+    /**
+     * @brief Continue an SNR point after the blocks of @p saved.
+     *
+     * The stopping rule is re-evaluated, so a point may be resumed with a
+     * larger budget or a tighter rule.
+     */
+    void restorePoint(size_t snr_index, const PointCheckpoint& saved) {
+        PointLedger& ledger = ledgers[snr_index];
+        std::lock_guard<std::mutex> lock(ledger.mutex);
+        ledger.next = saved.blocks;
+        ledger.errors = saved.errors;
+        ledger.bits = saved.bits;
+        ledger.weighted = saved.weighted;
+        ledger.weighted_sq = saved.weighted_sq;
+        issued[snr_index] = saved.blocks;
+        done_errors[snr_index] = saved.errors;
+        done_bits[snr_index] = saved.bits;
+        converged[snr_index] = params.stopping.convergedAt(
+            saved.errors, relCi95(saved.errors, saved.bits, saved.weighted,
+                                  saved.weighted_sq));
+    }
+
+    /// @brief True once a point has converged or spent its budget
+    bool finished(size_t snr_index) const {
+        return converged[snr_index].load() ||
+               issued[snr_index].load() >= max_blocks;
+    }
+
+    int levels;
+    std::string name;
+    SimulationParams params;
+    ModulatorQAM mod;
+    DemodulatorQAM demod;
+    /// @brief Bit multiple of the kernel's chunks (see payload_unit())
+    size_t payload_bits;
+    std::vector<double> snrs;
+    std::vector<uint64_t> errors;  ///< Totals, filled once the sweep is done
+    std::vector<uint64_t> bits;
+    std::vector<double> weighted;  ///< Importance-sampling totals
+    std::vector<double> weighted_sq;
+    std::vector<std::atomic<uint64_t>> issued;  ///< Blocks handed out
+    std::vector<std::atomic<bool>> converged;   ///< Stopping rule met
+    std::vector<PointLedger> ledgers;           ///< Counts of ordered points
+    uint64_t max_blocks = 0;                    ///< Block budget per point
+    bool ordered = false;  ///< Count blocks in order (see PointLedger)
+    std::vector<std::atomic<uint64_t>> busy_ns;  ///< Block time per point
+    /// @brief Live counts of the finished blocks (see recordProgress())
+    std::vector<std::atomic<uint64_t>> done_errors;
+    std::vector<std::atomic<uint64_t>> done_bits;
+    uint64_t steady_allocations = 0;
+    /// @brief Summed stage counters of the pipelined kernel
+    std::array<StageStats, StagePipelineResult::kStageCount> stages;
+    double stage_wall_s = 0.0;
+};
+
+/**
+ * @brief Error/bit accumulators of one SNR point owned by one worker.
+ *
+ * Only the owning worker writes, with plain load + store (no locked
+ * read-modify-write), and each instance fills its own cache line, so
+ * workers never contend on a line. Other threads may read the values to
+ * evaluate the stopping rule.
+ */
+struct alignas(64) PointCounters {
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> bits{0};
+
+    void add(uint64_t e, uint64_t b) {
+        errors.store(errors.load(std::memory_order_relaxed) + e,
+                     std::memory_order_relaxed);
+        bits.store(bits.load(std::memory_order_relaxed) + b,
+                   std::memory_order_relaxed);
+    }
+};
+
+/// @brief Symbols per tile of the fused kernel (a multiple of the noise tile)
+inline constexpr size_t kFusedTile = 1024;
+
+/**
+ * @brief Bits per streamed chunk of a block for @p job.
+ *
+ * block_bits rounded down to whole fused tiles (at least one), so chunk
+ * boundaries never split a noise tile and results do not depend on the
+ * chunk size; never more than the block itself. With a shared payload the
+ * tile is that of every order, so all jobs cut a block the same way.
+ */
+size_t chunk_bits(const ModulationJob& job);
+
+/**
+ * @brief Buffer sizes and channel of one worker for one job.
+ *
+ * Buffers hold one chunk of a block (see chunk_bits()) and are carved from
+ * the worker's arena at the start of every block (see carve()). The staged
+ * kernel needs the chunk's bits plus a chunk of samples s and decided bits
+ * r; the fused kernel only one tile of s and r. With a shared payload the
+ * bits are carved once for every job (WorkerState::payload). Importance
+ * sampling adds a copy x of the clean symbols of s, from which the noise of
+ * each errored symbol is recovered.
+ *
+ * Built by the worker that uses it, on first use, so its noise engine
+ * state is first touched on that worker's NUMA node. Its modulator and
+ * demodulator only point at the shared QamTraits tables.
+ */
+struct JobScratch {
+    explicit JobScratch(const ModulationJob& job)
+        : chunk(chunk_bits(job)),
+          noise(0.0, job.mod.getAveragePower(), job.params.noise_engine, 0),
+          mod(job.levels),
+          demod(job.levels),
+          weigh(job.importance()) {
+        noise.setImportanceBias(job.params.importance_bias_db);
+        const size_t symbols = chunk / job.mod.getBitsPerSymbol();
+        samples = job.params.kernel == BlockKernel::Staged
+                      ? symbols
+                      : std::min(kFusedTile, symbols);
+        decided_words =
+            PackedBits::wordsFor(samples * job.mod.getBitsPerSymbol());
+        const size_t planes = weigh ? 4 : 2;
+        arena_bytes = planes * Arena::bytesFor<float>(samples) +
+                      Arena::bytesFor<uint64_t>(decided_words);
+        if (!job.params.shared_payload) {
+            arena_bytes +=
+                Arena::bytesFor<uint64_t>(PackedBits::wordsFor(chunk));
+        }
+    }
+
+    /// @brief Carve s, r (and x) for the next block; valid until
+    /// arena.reset()
+    void carve(Arena& arena) {
+        auto plane = [&] { return arena.allocate<float>(samples).data(); };
+        float* re = plane();
+        float* im = plane();
+        s = SampleView(re, im, samples);
+        if (weigh) {
+            float* x_re = plane();
+            float* x_im = plane();
+            x = SampleView(x_re, x_im, samples);
+        }
+        r = arena.allocate<uint64_t>(decided_words);
+    }
+
+    size_t chunk = 0;          ///< Bits per streamed chunk
+    size_t samples = 0;        ///< Samples of s
+    size_t decided_words = 0;  ///< Words of r
+    size_t arena_bytes = 0;    ///< Arena space carve() and the bits take
+    SampleView s;
+    SampleView x;  ///< Clean symbols of s, with importance sampling only
+    std::span<uint64_t> r;
+    NoiseAdder noise;
+    ModulatorQAM mod;      ///< Worker's own modulator of the job's order
+    DemodulatorQAM demod;  ///< Worker's own demodulator of the job's order
+    bool weigh = false;    ///< Importance sampling: weigh every error
+    uint64_t allocations = 0;  ///< Heap allocations inside the kernel
+};
+
+/**
+ * @brief State owned by one pool worker: its bit source, block arena and
+ * per-job scratch.
+ *
+ * The pools build it lazily from the worker itself (see workerState()), so
+ * it lives on the worker's NUMA node.
+ */
+struct WorkerState {
+    WorkerState() = default;
+
+    /// @brief Empty scratch slots and zeroed counters for every job
+    explicit WorkerState(
+        const std::vector<std::unique_ptr<ModulationJob>>& jobs)
+        : scratch(jobs.size()),
+          counters(jobs.size()),
+          tallies(jobs.size()),
+          job_ns(jobs.size()) {
+        open.reserve(jobs.size());
+        for (size_t j = 0; j < jobs.size(); ++j) {
+            counters[j] = std::vector<PointCounters>(jobs[j]->snrs.size());
+        }
+    }
+
+    Xoshiro256 rng;  ///< Reseeded from blockSeeds() for every block
+    Arena arena;     ///< Bits, samples and decisions; reset every block
+    std::vector<std::unique_ptr<JobScratch>> scratch;  ///< Indexed by job
+    std::vector<std::vector<PointCounters>> counters;  ///< [job][snr]
+    std::span<uint64_t> payload;  ///< Chunk words of a shared-payload block
+    std::vector<size_t> open;         ///< Jobs run by a shared-payload unit
+    std::vector<BlockTally> tallies;  ///< Counts of a shared unit, by job
+    std::vector<uint64_t> job_ns;     ///< Time of a shared unit, by job
+};
+
+/**
+ * @brief The calling pool worker's entry of @p workers, built on first use.
+ */
+WorkerState& workerState(
+    std::vector<std::unique_ptr<WorkerState>>& workers,
+    const std::vector<std::unique_ptr<ModulationJob>>& jobs);
+
+/**
+ * @brief Simulates block @p block of bits_per_thread bits of one
+ * (modulation, SNR) point, streamed through buffers carved from the
+ * worker's arena one chunk at a time.
+ *
+ * The bit source and the noise engine restart from the block's own seeds,
+ * so the result depends only on the block, not on the worker.
+ */
+BlockTally run_block(ModulationJob& job, size_t job_index, size_t snr_index,
+                     uint64_t block, WorkerState& worker);
+
+/**
+ * @brief Simulates block @p block of SNR point @p snr_index for every job
+ * in worker.open from one shared payload.
+ *
+ * Each chunk of the block's bits is generated once and fed to every open
+ * job's kernel in turn; each job keeps its own noise stream. A job gets
+ * the counts run_block() gives it for the same block, in worker.tallies,
+ * and its kernel time plus a share of the bit generation in worker.job_ns.
+ */
+void run_shared_block(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                      size_t snr_index, uint64_t block, WorkerState& worker);
+
+/**
+ * @brief Fingerprint of the options the counts of @p jobs depend on.
+ *
+ * Covers the orders, SNR points, block size, noise engine, payload mode,
+ * importance bias and backend, but not the budget, stopping rule, thread
+ * count or kernel, which a resumed run may change.
+ */
+uint64_t config_fingerprint(
+    const std::vector<std::unique_ptr<ModulationJob>>& jobs);
+
+/**
+ * @brief Writes the counted blocks of every point to the checkpoint file,
+ * at most once per checkpoint interval.
+ *
+ * Any worker may call maybeWrite() after finishing a block; one of them
+ * takes the snapshot while the others carry on.
+ */
+class Checkpointer {
+   public:
+    Checkpointer(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                 const SimulationParams& params)
+        : jobs_(jobs),
+          path_(params.checkpoint_path),
+          interval_(std::chrono::duration_cast<Clock::duration>(
+              std::chrono::duration<double>(params.checkpoint_interval_s))),
+          seed_(params.seed.value_or(0)),
+          config_(config_fingerprint(jobs)),
+          due_(Clock::now() + interval_) {}
+
+    /**
+     * @brief Continue every point from @p saved.
+     *
+     * @throws std::runtime_error if @p saved belongs to a different sweep
+     */
+    void restore(const Checkpoint& saved) {
+        if (saved.seed != seed_ || saved.config != config_ ||
+            saved.modulations.size() != jobs_.size()) {
+            throw std::runtime_error(
+                "checkpoint " + path_ +
+                " was written by a run with a different seed, SNR range, "
+                "block size, noise engine, payload mode, importance bias or "
+                "backend");
+        }
+        for (size_t j = 0; j < jobs_.size(); ++j) {
+            for (size_t i = 0; i < jobs_[j]->snrs.size(); ++i) {
+                jobs_[j]->restorePoint(i, saved.modulations[j].points[i]);
+            }
+        }
+    }
+
+    /// @brief Write a checkpoint if the interval has passed
+    void maybeWrite() {
+        if (Clock::now() < due_.load(std::memory_order_relaxed)) return;
+        std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+        if (!lock || Clock::now() < due_.load()) return;
+        writeLocked();
+    }
+
+    /// @brief Write a checkpoint now
+    void write() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writeLocked();
+    }
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    void writeLocked() {
+        Checkpoint snapshot;
+        snapshot.seed = seed_;
+        snapshot.config = config_;
+        for (const auto& job : jobs_) {
+            ModulationCheckpoint mod;
+            mod.levels = job->levels;
+            for (size_t i = 0; i < job->snrs.size(); ++i) {
+                mod.points.push_back(job->savePoint(i));
+            }
+            snapshot.modulations.push_back(std::move(mod));
+        }
+        if (!writeCheckpoint(path_, snapshot)) {
+            std::cerr << "Could not write checkpoint " << path_ << "\n";
+        }
+        due_ = Clock::now() + interval_;
+    }
+
+    std::vector<std::unique_ptr<ModulationJob>>& jobs_;
+    std::string path_;
+    Clock::duration interval_;
+    uint64_t seed_;
+    uint64_t config_;
+    std::mutex mutex_;
+    std::atomic<Clock::time_point> due_;
+};
+
+/// @brief bits_per_thread of @p p padded to whole symbols of @p order
+size_t padded_bits(const SimulationParams& p, const Order& order);
+
+/**
+ * @brief One job per order of p.orders.
+ *
+ * @param announce Print a note for every padded bits_per_thread
+ */
+std::vector<std::unique_ptr<ModulationJob>> make_jobs(
+    const SimulationParams& p, bool announce);
+
+/**
+ * @brief The reporter of --progress, --status-file and --metrics-port for
+ * @p jobs, or null if none of them is given.
+ *
+ * @throws std::runtime_error if the metrics port cannot be bound
+ */
+std::unique_ptr<ProgressReporter> make_progress_reporter(
+    const SimulationParams& p,
+    const std::vector<std::unique_ptr<ModulationJob>>& jobs, bool points);
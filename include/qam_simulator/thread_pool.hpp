@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Persistent thread pool with per-worker work-stealing deques.
+ *
+ * Each worker owns a deque. Tasks submitted from a worker go to the back of
+ * its own deque and are popped LIFO; idle workers steal from the front of
+ * other deques. Tasks submitted from outside the pool are spread
+ * round-robin. A task may submit further tasks.
+ */
+class ThreadPool {
+   public:
+    using Task = std::function<void()>;
+    /// @brief Run by each worker, with its index, before it takes any task
+    using StartHook = std::function<void(int)>;
+
+    /**
+     * @brief Start @p num_threads workers (at least one).
+     *
+     * If @p on_start is set, every worker runs it before taking its first
+     * task (e.g. to pin itself to a CPU).
+     */
+    explicit ThreadPool(int num_threads, StartHook on_start = nullptr);
+
+    /**
+     * @brief Waits for all pending tasks, then stops the workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a task for execution.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Block until every submitted task (including tasks submitted by
+     * tasks) has finished.
+     *
+     * @throws The first exception thrown by a task, if any.
+     */
+    void wait();
+
+    /**
+     * @brief Number of worker threads.
+     */
+    int size() const noexcept { return static_cast<int>(threads_.size()); }
+
+    /**
+     * @brief Index of the calling worker in [0, size()), or -1 when called
+     * from a thread that does not belong to a pool.
+     */
+    static int currentWorker() noexcept;
+
+   private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(int index, const StartHook& on_start);
+    bool tryPop(int index, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex state_mutex_;
+    std::condition_variable wake_cv_;  ///< Signalled when work is queued
+    std::condition_variable idle_cv_;  ///< Signalled when pending_ hits 0
+    std::atomic<size_t> queued_{0};    ///< Tasks sitting in a deque
+    std::atomic<size_t> pending_{0};   ///< Tasks submitted, not finished
+    std::atomic<unsigned> next_queue_{0};
+    std::exception_ptr error_;
+    bool stop_ = false;
+};
@@ -0,0 +1,69 @@
+"""Compare the BER curves of two runs point by point.
+
+Usage: compare_ber.py DIR_A DIR_B [max_abs_z]
+
+Reads the ber_*.csv files both directories have, e.g. a --backend=cpu and
+a --backend=cuda run of the same sweep, and prints for every common SNR
+point z = (BER_a - BER_b) / sqrt(Var_a + Var_b), with each variance from
+the BERVariance column. Independent runs of the same channel give z close
+to N(0, 1); the script exits with status 1 if any |z| exceeds max_abs_z
+(default 4), and 2 if there is nothing to compare.
+"""
+import csv
+import glob
+import math
+import os
+import sys
+
+
+def load(path):
+    """Return {snr_db: (ber, variance, errors)} of one results file."""
+    points = {}
+    with open(path, newline='') as f:
+        for row in csv.DictReader(f):
+            ber = float(row['BER'])
+            bits = int(row['Bits'])
+            if 'BERVariance' in row:
+                var = float(row['BERVariance'])
+            else:
+                var = ber * (1.0 - ber) / bits if bits else math.inf
+            points[round(float(row['SNR_dB']), 9)] = (ber, var,
+                                                      int(row['Errors']))
+    return points
+
+
+def main():
+    if len(sys.argv) < 3:
+        print(__doc__)
+        return 2
+    dir_a, dir_b = sys.argv[1], sys.argv[2]
+    limit = float(sys.argv[3]) if len(sys.argv) > 3 else 4.0
+    compared = 0
+    worst = 0.0
+    for path_a in sorted(glob.glob(os.path.join(dir_a, 'ber_*.csv'))):
+        name = os.path.basename(path_a)
+        path_b = os.path.join(dir_b, name)
+        if not os.path.exists(path_b):
+            continue
+        a, b = load(path_a), load(path_b)
+        print(f'{name[4:-4]}:')
+        for snr in sorted(a.keys() & b.keys()):
+            (ber_a, var_a, err_a), (ber_b, var_b, err_b) = a[snr], b[snr]
+            if err_a == 0 and err_b == 0:
+                print(f'  SNR={snr:8.3f}  no errors in either run')
+                continue
+            z = (ber_a - ber_b) / math.sqrt(var_a + var_b)
+            worst = max(worst, abs(z))
+            compared += 1
+            flag = '  <--' if abs(z) > limit else ''
+            print(f'  SNR={snr:8.3f}  BER {ber_a:.4e} vs {ber_b:.4e}'
+                  f'  z={z:+.2f}{flag}')
+    if compared == 0:
+        print('No common points with errors')
+        return 2
+    print(f'{compared} points, max |z| = {worst:.2f} (limit {limit})')
+    return 1 if worst > limit else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -1,29 +1,70 @@
-# import pandas as pd
-# import matplotlib.pyplot as plt
-
-# df = pd.read_csv('./build/ber_qpsk.csv')
-# plt.semilogy(df['SNR_dB'], df['BER'], marker='o')
-# plt.xlabel('SNR, dB')
-# plt.ylabel('BER')
-# plt.grid(True, which='both')
-# plt.savefig('ber_vs_snr.png')
+# import glob
+import os
+import struct
+import sys
 
-import pandas as pd
 import matplotlib.pyplot as plt
-import glob
-import os
+import numpy as np
+import pandas as pd
 
-file_paths = glob.glob('./ber_*.csv')
+RESULTS_FILE = 'qam_results.qbr'
+NAMES = {4: 'qpsk', 16: 'qam16', 64: 'qam64', 256: 'qam256',
+         1024: 'qam1024', 4096: 'qam4096'}
 
-plt.figure(figsize=(10, 6))
 
-for file_path in file_paths:
-    df = pd.read_csv(file_path)
+def load_results(path):
+    """Load a binary results file written with --results=binary|both.
 
-    filename = os.path.basename(file_path)
-    config_name = os.path.splitext(filename)[0][4:]
+    Returns (DataFrame, metadata dict). Every column is a read-only
+    np.memmap into the file, so millions of rows load without parsing text.
+    See BinaryResultsSink in results_sink.hpp for the layout.
+    """
+    with open(path, 'rb') as f:
+        magic, version, count = struct.unpack('<8sII', f.read(16))
+        if magic != b'QAMRES01' or version != 1:
+            raise ValueError(f'{path} is not a QAM results file')
+        metadata = {}
+        offset = 16
+        for _ in range(count):
+            fields = []
+            for _ in range(2):
+                (n,) = struct.unpack('<I', f.read(4))
+                fields.append(f.read(n).decode())
+                offset += 4 + n
+            metadata[fields[0]] = fields[1]
+        f.seek((offset + 7) // 8 * 8)
+        rows, ncols, _ = struct.unpack('<QII', f.read(16))
+        columns = {}
+        for _ in range(ncols):
+            name, dtype, col_offset = struct.unpack('<16s8sQ', f.read(32))
+            name = name.rstrip(b'\0').decode()
+            dtype = np.dtype(dtype.rstrip(b'\0').decode())
+            columns[name] = (np.memmap(path, dtype=dtype, mode='r',
+                                       offset=col_offset, shape=(rows,))
+                             if rows else np.empty(0, dtype=dtype))
+    return pd.DataFrame(columns), metadata
+
+
+def load_curves():
+    """Yield (label, snr_db, ber) per configuration."""
+    path = sys.argv[1] if len(sys.argv) > 1 else RESULTS_FILE
+    if os.path.exists(path):
+        df, _ = load_results(path)
+        for levels, group in df.groupby('levels'):
+            label = NAMES.get(levels, f'{levels}-QAM')
+            yield label, group['snr_db'], group['ber']
+        return
+    for file_path in glob.glob('./ber_*.csv'):
+        df = pd.read_csv(file_path)
+        filename = os.path.basename(file_path)
+        config_name = os.path.splitext(filename)[0][4:]
+        yield config_name, df['SNR_dB'], df['BER']
+
+
+plt.figure(figsize=(10, 6))
 
-    plt.semilogy(df['SNR_dB'], df['BER'], marker='o', label=config_name)
+for config_name, snr_db, ber in load_curves():
+    plt.semilogy(snr_db, ber, marker='o', label=config_name)
 
 plt.xlabel('SNR, dB')
 plt.ylabel('BER')
@@ -34,4 +75,4 @@ plt.title('BER vs SNR ')
 plt.tight_layout()
 # plt.savefig('ber_vs_snr_combined.png')
 
-plt.show()
\ No newline at end of file
+plt.show()
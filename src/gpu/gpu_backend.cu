@@ -0,0 +1,186 @@
+#include <cuda_runtime.h>
+#include <curand_kernel.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "qam_simulator/gpu_backend.hpp"
+#include "qam_simulator/qam_traits.hpp"
+
+namespace gpu {
+namespace {
+
+constexpr int kThreads = 256;  ///< Threads per CUDA block
+constexpr int kWarp = 32;
+/// @brief Symbols each thread handles at least, before the grid is capped
+constexpr uint64_t kSymbolsPerThread = 16;
+/// @brief Largest grid width; fixed rather than derived from the device,
+/// so a seed gives the same counts on every GPU
+constexpr uint64_t kMaxGridWidth = 4096;
+/// @brief Largest gridDim.y, which indexes the blocks of a batch
+constexpr size_t kMaxBatch = 65535;
+
+static_assert(sizeof(unsigned long long) == sizeof(uint64_t));
+
+void check(cudaError_t status, const char* what) {
+    if (status != cudaSuccess) {
+        throw std::runtime_error(std::string("CUDA: ") + what + ": " +
+                                 cudaGetErrorString(status));
+    }
+}
+
+/// @brief Arguments of berKernel()
+struct LaunchParams {
+    uint64_t symbols = 0;  ///< Symbols per block
+    const uint64_t* bit_seeds = nullptr;
+    const uint64_t* noise_seeds = nullptr;
+    unsigned long long* errors = nullptr;  ///< One counter per block
+    float sigma = 0.0f;
+    int half_bits = 0;  ///< Label bits per axis
+};
+
+/// @brief Axis position of Gray word @p g (prefix XOR, up to 16 bits)
+__device__ __forceinline__ unsigned inverseGray(unsigned g) {
+    g ^= g >> 1;
+    g ^= g >> 2;
+    g ^= g >> 4;
+    g ^= g >> 8;
+    return g;
+}
+
+/// @brief Gray word of the level nearest @p y on an axis of @p levels
+/// unscaled points (odd integers)
+__device__ __forceinline__ unsigned slice(float y, int levels) {
+    int k = __float2int_rd((y + static_cast<float>(levels)) * 0.5f);
+    k = min(max(k, 0), levels - 1);
+    return static_cast<unsigned>(k ^ (k >> 1));
+}
+
+/**
+ * @brief Fused chain of one batch: blockIdx.y selects the simulated
+ * block, and the threads of its row stride over the block's symbols.
+ *
+ * Thread t of a row uses Philox subsequence t of the block's bit and noise
+ * seeds. Errors are summed per thread, per warp with shuffles and per CUDA
+ * block in shared memory, then added to the block's counter.
+ */
+__global__ void berKernel(LaunchParams p) {
+    const unsigned row = blockIdx.y;
+    const uint64_t first =
+        static_cast<uint64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    const uint64_t stride = static_cast<uint64_t>(gridDim.x) * blockDim.x;
+
+    curandStatePhilox4_32_10_t bits_rng;
+    curandStatePhilox4_32_10_t noise_rng;
+    curand_init(p.bit_seeds[row], first, 0, &bits_rng);
+    curand_init(p.noise_seeds[row], first, 0, &noise_rng);
+
+    const int levels = 1 << p.half_bits;
+    const unsigned mask = static_cast<unsigned>(levels - 1);
+    const float offset = static_cast<float>(levels - 1);
+    unsigned long long errors = 0;
+    for (uint64_t s = first; s < p.symbols; s += stride) {
+        const unsigned label = curand(&bits_rng);
+        const unsigned gi = (label >> p.half_bits) & mask;
+        const unsigned gq = label & mask;
+        const float2 n = curand_normal2(&noise_rng);
+        const float yi = 2.0f * inverseGray(gi) - offset + p.sigma * n.x;
+        const float yq = 2.0f * inverseGray(gq) - offset + p.sigma * n.y;
+        errors += __popc(gi ^ slice(yi, levels)) +
+                  __popc(gq ^ slice(yq, levels));
+    }
+
+    __shared__ unsigned long long warp_sums[kThreads / kWarp];
+    for (int shift = kWarp / 2; shift > 0; shift /= 2) {
+        errors += __shfl_down_sync(0xffffffffu, errors, shift);
+    }
+    const unsigned lane = threadIdx.x % kWarp;
+    const unsigned warp = threadIdx.x / kWarp;
+    if (lane == 0) warp_sums[warp] = errors;
+    __syncthreads();
+    if (warp != 0) return;
+    errors = lane < blockDim.x / kWarp ? warp_sums[lane] : 0;
+    for (int shift = kWarp / 2; shift > 0; shift /= 2) {
+        errors += __shfl_down_sync(0xffffffffu, errors, shift);
+    }
+    if (lane == 0) atomicAdd(&p.errors[row], errors);
+}
+
+}  // namespace
+
+struct BlockRunner::Impl {
+    uint64_t* bit_seeds = nullptr;
+    uint64_t* noise_seeds = nullptr;
+    unsigned long long* errors = nullptr;
+    std::string name;
+
+    ~Impl() {
+        cudaFree(bit_seeds);
+        cudaFree(noise_seeds);
+        cudaFree(errors);
+    }
+};
+
+BlockRunner::BlockRunner(size_t max_blocks)
+    : impl_(std::make_unique<Impl>()),
+      max_blocks_(std::clamp<size_t>(max_blocks, 1, kMaxBatch)) {
+    int devices = 0;
+    check(cudaGetDeviceCount(&devices), "cudaGetDeviceCount");
+    if (devices == 0) throw std::runtime_error("CUDA: no device found");
+    check(cudaSetDevice(0), "cudaSetDevice");
+    cudaDeviceProp props{};
+    check(cudaGetDeviceProperties(&props, 0), "cudaGetDeviceProperties");
+    impl_->name = std::string(props.name) + " (sm_" +
+                  std::to_string(props.major) + std::to_string(props.minor) +
+                  ")";
+    const size_t bytes = max_blocks_ * sizeof(uint64_t);
+    check(cudaMalloc(&impl_->bit_seeds, bytes), "cudaMalloc");
+    check(cudaMalloc(&impl_->noise_seeds, bytes), "cudaMalloc");
+    check(cudaMalloc(&impl_->errors, bytes), "cudaMalloc");
+}
+
+BlockRunner::~BlockRunner() = default;
+
+void BlockRunner::run(const BlockBatch& batch, std::span<uint64_t> errors) {
+    const size_t blocks = errors.size();
+    if (blocks > max_blocks_ || batch.bit_seeds.size() != blocks ||
+        batch.noise_seeds.size() != blocks) {
+        throw std::invalid_argument(
+            "BlockRunner: batch does not match its seeds or the runner");
+    }
+    if (blocks == 0) return;
+    const int bps = qamBitsPerSymbol(batch.levels);
+
+    LaunchParams p;
+    p.symbols = batch.block_bits / static_cast<uint64_t>(bps);
+    p.bit_seeds = impl_->bit_seeds;
+    p.noise_seeds = impl_->noise_seeds;
+    p.errors = impl_->errors;
+    p.sigma = batch.sigma;
+    p.half_bits = bps / 2;
+
+    const size_t bytes = blocks * sizeof(uint64_t);
+    check(cudaMemcpy(impl_->bit_seeds, batch.bit_seeds.data(), bytes,
+                     cudaMemcpyHostToDevice),
+          "cudaMemcpy");
+    check(cudaMemcpy(impl_->noise_seeds, batch.noise_seeds.data(), bytes,
+                     cudaMemcpyHostToDevice),
+          "cudaMemcpy");
+    check(cudaMemset(impl_->errors, 0, bytes), "cudaMemset");
+
+    const uint64_t per_row = kThreads * kSymbolsPerThread;
+    const uint64_t width = std::clamp<uint64_t>(
+        (p.symbols + per_row - 1) / per_row, 1, kMaxGridWidth);
+    berKernel<<<dim3(static_cast<unsigned>(width),
+                     static_cast<unsigned>(blocks)),
+                kThreads>>>(p);
+    check(cudaGetLastError(), "kernel launch");
+    check(cudaMemcpy(errors.data(), impl_->errors, bytes,
+                     cudaMemcpyDeviceToHost),
+          "cudaMemcpy");
+}
+
+std::string BlockRunner::describe() const { return impl_->name; }
+
+}  // namespace gpu
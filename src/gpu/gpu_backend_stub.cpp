@@ -0,0 +1,24 @@
+#include <stdexcept>
+
+#include "qam_simulator/gpu_backend.hpp"
+
+// Built instead of gpu_backend.cu when QAM_ENABLE_CUDA is OFF
+
+namespace gpu {
+
+struct BlockRunner::Impl {};
+
+BlockRunner::BlockRunner(size_t) {
+    throw std::runtime_error(
+        "this build has no CUDA backend; configure with -DQAM_ENABLE_CUDA=ON");
+}
+
+BlockRunner::~BlockRunner() = default;
+
+void BlockRunner::run(const BlockBatch&, std::span<uint64_t>) {
+    throw std::runtime_error("this build has no CUDA backend");
+}
+
+std::string BlockRunner::describe() const { return "none"; }
+
+}  // namespace gpu
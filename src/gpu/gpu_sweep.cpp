@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "qam_simulator/gpu_backend.hpp"
+#include "qam_simulator/noise.hpp"
+#include "qam_simulator/rng.hpp"
+#include "qam_simulator/sweep.hpp"
+
+// Host side of --backend=cuda: batching, seeds and in-order folding of the
+// counts. Built with either backend; the device work goes through
+// BlockRunner.
+
+namespace gpu {
+
+namespace {
+
+/// @brief Bits the CUDA backend aims to run per launch
+constexpr uint64_t kGpuBatchBits = uint64_t{1} << 32;
+
+/// @brief Most blocks of one CUDA launch
+constexpr size_t kGpuMaxBatch = 4096;
+
+/**
+ * @brief Host side of one CUDA launch: the blocks it runs and their seeds
+ * and counts.
+ */
+struct GpuBatch {
+    std::vector<uint64_t> blocks;
+    std::vector<uint64_t> bit_seeds;
+    std::vector<uint64_t> noise_seeds;
+    std::vector<uint64_t> errors;
+
+    /// @brief Run the blocks of SNR point @p snr_index of @p job
+    void run(BlockRunner& runner, const ModulationJob& job,
+             size_t snr_index) {
+        bit_seeds.clear();
+        noise_seeds.clear();
+        for (uint64_t block : blocks) {
+            const BlockSeeds seeds =
+                blockSeeds(job.streamKey(snr_index), block);
+            bit_seeds.push_back(seeds.bits);
+            noise_seeds.push_back(seeds.noise);
+        }
+        errors.resize(blocks.size());
+        const NoiseAdder channel(job.snrs[snr_index],
+                                 job.mod.getAveragePower(),
+                                 job.params.noise_engine, 0);
+        runner.run({job.levels, channel.getSigma(),
+                    job.params.bits_per_thread, bit_seeds, noise_seeds},
+                   errors);
+    }
+};
+
+}  // namespace
+
+void runSweep(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+              Checkpointer* checkpointer) {
+    BlockRunner runner(kGpuMaxBatch);
+    std::cout << "GPU: " << runner.describe() << "\n";
+    GpuBatch batch;
+    for (auto& job_ptr : jobs) {
+        ModulationJob& job = *job_ptr;
+        const size_t per_launch = std::clamp<size_t>(
+            kGpuBatchBits / std::max<uint64_t>(1, job.params.bits_per_thread),
+            1, runner.maxBlocks());
+        for (size_t i = 0; i < job.snrs.size(); ++i) {
+            for (;;) {
+                batch.blocks.clear();
+                uint64_t block = 0;
+                while (batch.blocks.size() < per_launch &&
+                       job.reserveBlock(i, block)) {
+                    batch.blocks.push_back(block);
+                }
+                if (batch.blocks.empty()) break;
+                const auto start = std::chrono::steady_clock::now();
+                batch.run(runner, job, i);
+                job.busy_ns[i] += static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count());
+                for (size_t k = 0; k < batch.blocks.size(); ++k) {
+                    job.recordProgress(i, batch.errors[k],
+                                       job.params.bits_per_thread);
+                    job.commitBlock(i, batch.blocks[k],
+                                    {batch.errors[k],
+                                     job.params.bits_per_thread});
+                }
+                if (checkpointer) checkpointer->maybeWrite();
+            }
+            const PointCheckpoint point = job.savePoint(i);
+            job.errors[i] = point.errors;
+            job.bits[i] = point.bits;
+        }
+    }
+}
+
+uint64_t replayBlock(const ModulationJob& job, size_t snr_index,
+                     uint64_t block) {
+    BlockRunner runner(1);
+    GpuBatch batch;
+    batch.blocks = {block};
+    batch.run(runner, job, snr_index);
+    return batch.errors.front();
+}
+
+}  // namespace gpu
@@ -0,0 +1,141 @@
+#include "qam_simulator/affinity.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+/// @brief CPU ids of a sysfs list such as "0-3,8-11"
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        const size_t dash = range.find('-');
+        const int first = std::stoi(range.substr(0, dash));
+        const int last = dash == std::string::npos
+                             ? first
+                             : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+/// @brief CPUs this process may run on (every CPU seen if unknown)
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+CpuTopology detect() {
+    const std::vector<int> allowed = allowed_cpus();
+    auto usable = [&](int cpu) {
+        return std::find(allowed.begin(), allowed.end(), cpu) != allowed.end();
+    };
+    CpuTopology topology;
+    // Node ids may have gaps (offline or memory-only nodes), so probe a range
+    constexpr int kMaxNodes = 1024;
+    for (int node = 0; node < kMaxNodes; ++node) {
+        std::ifstream in("/sys/devices/system/node/node" +
+                         std::to_string(node) + "/cpulist");
+        if (!in) continue;
+        std::string list;
+        std::getline(in, list);
+        std::vector<int> cpus;
+        try {
+            for (int cpu : parse_cpu_list(list)) {
+                if (usable(cpu)) cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            continue;
+        }
+        if (!cpus.empty()) topology.nodes.push_back(std::move(cpus));
+    }
+    if (topology.nodes.empty() && !allowed.empty()) {
+        topology.nodes.push_back(allowed);
+    }
+    return topology;
+}
+
+}  // namespace
+
+AffinityMode parseAffinityMode(std::string_view name) {
+    if (name == "none") return AffinityMode::None;
+    if (name == "core") return AffinityMode::Core;
+    if (name == "node") return AffinityMode::Node;
+    throw std::invalid_argument("unknown affinity " + std::string(name));
+}
+
+const char* affinityModeName(AffinityMode mode) noexcept {
+    switch (mode) {
+        case AffinityMode::None:
+            return "none";
+        case AffinityMode::Core:
+            return "core";
+        case AffinityMode::Node:
+            return "node";
+    }
+    return "?";
+}
+
+const CpuTopology& CpuTopology::host() {
+    static const CpuTopology topology = detect();
+    return topology;
+}
+
+AffinityPlan::AffinityPlan(AffinityMode mode, const CpuTopology& topology)
+    : mode_(topology.nodes.empty() ? AffinityMode::None : mode),
+      nodes_(topology.nodes) {}
+
+size_t AffinityPlan::nodeOf(int worker) const {
+    if (mode_ == AffinityMode::None || worker < 0) return 0;
+    return static_cast<size_t>(worker) % nodes_.size();
+}
+
+bool AffinityPlan::pin(int worker) const {
+    if (mode_ == AffinityMode::None || worker < 0) return false;
+#ifdef __linux__
+    const std::vector<int>& node = nodes_[nodeOf(worker)];
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (mode_ == AffinityMode::Core) {
+        const size_t round = static_cast<size_t>(worker) / nodes_.size();
+        CPU_SET(node[round % node.size()], &set);
+    } else {
+        for (int cpu : node) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+std::string AffinityPlan::describe() const {
+    std::ostringstream os;
+    os << affinityModeName(mode_);
+    if (mode_ != AffinityMode::None) {
+        size_t cpus = 0;
+        for (const auto& node : nodes_) cpus += node.size();
+        os << " (" << nodes_.size()
+           << (nodes_.size() == 1 ? " node, " : " nodes, ") << cpus
+           << (cpus == 1 ? " CPU)" : " CPUs)");
+    }
+    return os.str();
+}
@@ -0,0 +1,498 @@
+#include "qam_simulator/distributed.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "qam_simulator/affinity.hpp"
+#include "qam_simulator/net.hpp"
+#include "qam_simulator/progress.hpp"
+#include "qam_simulator/simd.hpp"
+#include "qam_simulator/thread_pool.hpp"
+
+namespace {
+
+/// @brief Message types of the distributed sweep protocol
+enum WireMessage : uint32_t {
+    kWireHello = 1,  ///< Worker -> coordinator: magic, version, threads
+    kWireConfig,     ///< Coordinator -> worker: the sweep parameters
+    kWireResults,    ///< Worker -> coordinator: counts, next batch size
+    kWireWork        ///< Coordinator -> worker: units (none = finished)
+};
+
+constexpr uint32_t kWireMagic = 0x51414D44;  // "QAMD"
+constexpr uint32_t kWireVersion = 4;
+
+/// @brief Units a worker asks for per thread, to hide the round trip
+constexpr uint32_t kRemoteUnitsPerThread = 2;
+/// @brief Most threads the coordinator sizes one worker's batches for
+constexpr uint32_t kMaxWorkerThreads = 1024;
+
+/// @brief Longest wait for the hello of a new connection
+constexpr int kHelloTimeoutMs = 10000;
+/// @brief Longest wait for each chunk of a message once it has started
+constexpr int kMessageTimeoutMs = 30000;
+/// @brief How often a connection waiting for results checks its lease and
+/// the end of the sweep
+constexpr int kLeasePollMs = 200;
+
+/// @brief One block of one (modulation, SNR) point, as sent to a worker
+struct WorkUnit {
+    uint32_t job = 0;
+    uint32_t snr = 0;
+    uint64_t block = 0;
+
+    bool operator==(const WorkUnit&) const = default;
+};
+
+/// @brief Counts of a finished unit, as sent back to the coordinator
+struct UnitResult {
+    WorkUnit unit;
+    uint64_t errors = 0;
+    uint64_t bits = 0;
+    uint64_t busy_ns = 0;
+    double weighted = 0.0;  ///< See BlockTally
+    double weighted_sq = 0.0;
+};
+
+/// @brief The parameters a worker needs to rebuild the jobs of @p p
+MessageWriter write_config(const SimulationParams& p) {
+    MessageWriter w;
+    w.put(p.seed.value_or(0))
+        .put(p.snr_start)
+        .put(p.snr_end)
+        .put(p.snr_step)
+        .put(static_cast<uint64_t>(p.bits_per_thread))
+        .put(static_cast<uint32_t>(p.noise_engine))
+        .put(static_cast<uint32_t>(p.kernel))
+        .put(static_cast<uint64_t>(p.block_bits))
+        .put(static_cast<uint32_t>(p.shared_payload))
+        .put(static_cast<uint32_t>(p.orders.size()));
+    for (int levels : p.orders) w.put(static_cast<uint32_t>(levels));
+    w.put(p.importance_bias_db);
+    return w;
+}
+
+/**
+ * @brief The sweep of a write_config() message, run with the threads,
+ * affinity and reporting options of @p local.
+ *
+ * @throws std::runtime_error if a value is out of range or missing
+ */
+SimulationParams read_config(MessageReader& config,
+                             const SimulationParams& local) {
+    SimulationParams p = local;
+    p.seed = config.get<uint64_t>();
+    p.snr_start = config.get<double>();
+    p.snr_end = config.get<double>();
+    p.snr_step = config.get<double>();
+    p.bits_per_thread = config.get<uint64_t>();
+    p.noise_engine = static_cast<NoiseEngineKind>(config.get<uint32_t>());
+    p.kernel = static_cast<BlockKernel>(config.get<uint32_t>());
+    p.block_bits = config.get<uint64_t>();
+    // Units still name one order each; the shared payload only changes
+    // which bits a block draws
+    p.shared_payload = config.get<uint32_t>() != 0;
+    const uint32_t orders = config.get<uint32_t>();
+    if (orders == 0 || orders > std::size(kOrders)) {
+        throw std::runtime_error("coordinator sent a bad order count");
+    }
+    p.orders.resize(orders);
+    for (int& levels : p.orders) {
+        levels = static_cast<int>(config.get<uint32_t>());
+        if (!find_order(levels)) {
+            throw std::runtime_error("coordinator sent an unknown order");
+        }
+    }
+    p.importance_bias_db = config.get<double>();
+    if (!(p.importance_bias_db >= 0.0) ||
+        !std::isfinite(p.importance_bias_db)) {
+        throw std::runtime_error("coordinator sent a bad importance bias");
+    }
+    // Every kernel gives a block the same counts; run them fused
+    if (p.kernel == BlockKernel::Pipelined) p.kernel = BlockKernel::Fused;
+    p.stopping = StoppingRule{};
+    p.checkpoint_path.clear();
+    return p;
+}
+
+/**
+ * @brief Hands (modulation, SNR, block) units to remote workers over TCP
+ * and folds their counts in block order.
+ *
+ * Each worker pulls a batch of units, runs them and sends the counts back
+ * together with the request for its next batch. Units of a worker that
+ * disconnects, or that has not answered when the batch's lease
+ * (SimulationParams::lease_s) runs out, are handed out again, so a lost or
+ * stalled node only costs time. Batches are capped by the worker's thread
+ * count, and only counts of units handed to that worker are accepted.
+ * Counts go through the same PointLedger as local adaptive runs, so the
+ * totals equal those of a single-process run with the same seed and
+ * budget.
+ */
+class Coordinator {
+   public:
+    Coordinator(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                const SimulationParams& params, Checkpointer* checkpointer)
+        : jobs_(jobs), params_(params), checkpointer_(checkpointer) {
+        size_t max_snrs = 0;
+        for (const auto& job : jobs_)
+            max_snrs = std::max(max_snrs, job->snrs.size());
+        for (size_t i = 0; i < max_snrs; ++i) {
+            for (size_t j = 0; j < jobs_.size(); ++j) {
+                if (i < jobs_[j]->snrs.size()) {
+                    points_.push_back(
+                        {static_cast<uint32_t>(j), static_cast<uint32_t>(i)});
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Serve workers on @p port until every point has finished.
+     *
+     * @throws std::runtime_error if the port cannot be bound
+     */
+    void run(uint16_t port) {
+        Listener listener(port);
+        std::cout << "Coordinator listening on port " << listener.port()
+                  << std::endl;
+        std::list<Connection> connections;
+        while (!complete()) {
+            Socket socket = listener.accept(200);
+            if (socket.valid()) {
+                Connection& connection = connections.emplace_back();
+                connection.thread = std::thread(
+                    [this, &connection, socket = std::move(socket)]() mutable {
+                        serve(std::move(socket));
+                        connection.done.store(true,
+                                              std::memory_order_release);
+                    });
+            }
+            // Reap the threads of workers that already left
+            for (auto it = connections.begin(); it != connections.end();) {
+                if (it->done.load(std::memory_order_acquire)) {
+                    it->thread.join();
+                    it = connections.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        for (auto& connection : connections) connection.thread.join();
+        for (auto& job : jobs_) {
+            for (size_t i = 0; i < job->snrs.size(); ++i) {
+                const PointCheckpoint point = job->savePoint(i);
+                job->errors[i] = point.errors;
+                job->bits[i] = point.bits;
+                job->weighted[i] = point.weighted;
+                job->weighted_sq[i] = point.weighted_sq;
+            }
+        }
+    }
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    /// @brief Thread of one worker connection
+    struct Connection {
+        std::thread thread;
+        std::atomic<bool> done{false};  ///< Set once serve() has returned
+    };
+
+    /// @brief Talk to one worker until the sweep ends or the worker leaves
+    void serve(Socket socket) {
+        // Units handed to this worker and not yet counted; expired ones
+        // ran out of lease but are still accepted from the worker
+        std::vector<WorkUnit> outstanding;
+        std::vector<WorkUnit> expired;
+        uint32_t type = 0;
+        std::vector<std::byte> payload;
+        try {
+            if (!socket.waitReadable(kHelloTimeoutMs) ||
+                !recvMessage(socket, type, payload, kMessageTimeoutMs) ||
+                type != kWireHello) {
+                std::cerr << "Coordinator: dropped a client that sent no "
+                             "hello\n";
+                return;
+            }
+            MessageReader hello(payload);
+            if (hello.get<uint32_t>() != kWireMagic ||
+                hello.get<uint32_t>() != kWireVersion) {
+                std::cerr << "Coordinator: rejected a worker speaking "
+                             "another protocol\n";
+                return;
+            }
+            const uint32_t threads = hello.get<uint32_t>();
+            const uint32_t max_batch =
+                kRemoteUnitsPerThread *
+                std::clamp<uint32_t>(threads, 1, kMaxWorkerThreads);
+            std::cout << "Worker joined with " << threads << " threads"
+                      << std::endl;
+            if (!sendMessage(socket, kWireConfig,
+                             write_config(params_).bytes())) return;
+
+            const auto lease = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(params_.lease_s));
+            Clock::time_point deadline;
+            MessageWriter reply;
+            for (;;) {
+                // Poll, so a stalled worker neither keeps its units past
+                // the lease nor holds up the end of the sweep
+                while (!socket.waitReadable(kLeasePollMs)) {
+                    if (!outstanding.empty() && Clock::now() >= deadline) {
+                        std::cerr << "Coordinator: lease of "
+                                  << outstanding.size()
+                                  << " units ran out, requeueing them\n";
+                        expired.insert(expired.end(), outstanding.begin(),
+                                       outstanding.end());
+                        requeue(outstanding);
+                    }
+                    if (complete()) {
+                        std::cerr << "Coordinator: sweep finished, dropping "
+                                     "a stalled worker\n";
+                        return;
+                    }
+                }
+                if (!recvMessage(socket, type, payload, kMessageTimeoutMs) ||
+                    type != kWireResults) {
+                    break;
+                }
+                MessageReader results(payload);
+                const uint32_t count = results.get<uint32_t>();
+                const uint32_t wanted =
+                    std::clamp<uint32_t>(results.get<uint32_t>(), 1,
+                                         max_batch);
+                size_t unleased = 0;
+                for (uint32_t k = 0; k < count; ++k) {
+                    const UnitResult result = results.get<UnitResult>();
+                    if (release(outstanding, result.unit) ||
+                        release(expired, result.unit)) {
+                        commit(result);
+                    } else {
+                        ++unleased;
+                    }
+                }
+                if (unleased > 0) {
+                    std::cerr << "Coordinator: dropped " << unleased
+                              << " results for units the worker was not "
+                                 "handed\n";
+                }
+                // Units the worker skipped go to the others
+                requeue(outstanding);
+                expired.clear();
+                outstanding = take(wanted);
+                reply.clear();
+                reply.put(static_cast<uint32_t>(outstanding.size()));
+                for (const WorkUnit& unit : outstanding) reply.put(unit);
+                if (!sendMessage(socket, kWireWork, reply.bytes())) break;
+                if (outstanding.empty()) return;
+                deadline = Clock::now() + lease;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Coordinator: " << e.what() << "\n";
+        }
+        std::cerr << "Coordinator: worker left, requeueing "
+                  << outstanding.size() << " units\n";
+        requeue(outstanding);
+    }
+
+    /// @brief Remove @p unit from @p units; false if it is not there
+    static bool release(std::vector<WorkUnit>& units, const WorkUnit& unit) {
+        const auto it = std::find(units.begin(), units.end(), unit);
+        if (it == units.end()) return false;
+        *it = units.back();
+        units.pop_back();
+        return true;
+    }
+
+    /**
+     * @brief Hand @p units out again and clear them.
+     *
+     * Counts that still arrive for them later are dropped by commitBlock()
+     * if the block was counted meanwhile.
+     */
+    void requeue(std::vector<WorkUnit>& units) {
+        if (units.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requeued_.insert(requeued_.end(), units.begin(), units.end());
+        }
+        units.clear();
+        work_cv_.notify_all();
+    }
+
+    /// @brief Count a returned unit
+    void commit(const UnitResult& result) {
+        if (result.unit.job >= jobs_.size() ||
+            result.unit.snr >= jobs_[result.unit.job]->snrs.size()) {
+            throw std::runtime_error("result for an unknown point");
+        }
+        ModulationJob& job = *jobs_[result.unit.job];
+        job.commitBlock(result.unit.snr, result.unit.block,
+                        {result.errors, result.bits, result.weighted,
+                         result.weighted_sq});
+        job.busy_ns[result.unit.snr].fetch_add(result.busy_ns,
+                                               std::memory_order_relaxed);
+        job.recordProgress(result.unit.snr, result.errors, result.bits);
+        if (checkpointer_) checkpointer_->maybeWrite();
+        work_cv_.notify_all();
+    }
+
+    /**
+     * @brief Up to @p count units: requeued ones first, then new blocks of
+     * the open points in round-robin order.
+     *
+     * Waits while nothing is left to hand out but units are still out.
+     *
+     * @return No units once the sweep has finished
+     */
+    std::vector<WorkUnit> take(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            std::vector<WorkUnit> units;
+            while (units.size() < count && !requeued_.empty()) {
+                const WorkUnit unit = requeued_.front();
+                requeued_.pop_front();
+                if (!jobs_[unit.job]->converged[unit.snr]) {
+                    units.push_back(unit);
+                }
+            }
+            for (size_t idle = 0;
+                 units.size() < count && idle < points_.size();) {
+                const WorkUnit point = points_[cursor_++ % points_.size()];
+                uint64_t block = 0;
+                if (jobs_[point.job]->reserveBlock(point.snr, block)) {
+                    units.push_back({point.job, point.snr, block});
+                    idle = 0;
+                } else {
+                    ++idle;
+                }
+            }
+            if (!units.empty() || complete()) return units;
+            work_cv_.wait_for(lock, std::chrono::milliseconds(100));
+        }
+    }
+
+    /// @brief True once every point has converged or counted its budget
+    bool complete() {
+        for (auto& job : jobs_) {
+            for (size_t i = 0; i < job->snrs.size(); ++i) {
+                if (job->converged[i]) continue;
+                if (job->savePoint(i).blocks < job->max_blocks) return false;
+            }
+        }
+        return true;
+    }
+
+    std::vector<std::unique_ptr<ModulationJob>>& jobs_;
+    const SimulationParams& params_;
+    Checkpointer* checkpointer_;  ///< Null unless checkpointing
+    std::vector<WorkUnit> points_;  ///< (job, snr) pairs, block unused
+    size_t cursor_ = 0;
+    std::mutex mutex_;  ///< Guards cursor_ and requeued_
+    std::condition_variable work_cv_;
+    /// @brief Units of workers that left or ran out of lease
+    std::deque<WorkUnit> requeued_;
+};
+
+}  // namespace
+
+void run_coordinator(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                     const SimulationParams& params,
+                     Checkpointer* checkpointer, uint16_t port) {
+    Coordinator(jobs, params, checkpointer).run(port);
+}
+
+void run_worker(const SimulationParams& local) {
+    const size_t colon = local.connect_to.rfind(':');
+    const std::string host = local.connect_to.substr(0, colon);
+    const auto port = static_cast<uint16_t>(
+        std::stoul(local.connect_to.substr(colon + 1)));
+    Socket socket = Socket::connect(host, port);
+
+    const AffinityPlan affinity(local.affinity, CpuTopology::host());
+    ThreadPool pool(local.num_threads,
+                    [&affinity](int w) { affinity.pin(w); });
+    MessageWriter out;
+    out.put(kWireMagic).put(kWireVersion).put(
+        static_cast<uint32_t>(pool.size()));
+    uint32_t type = 0;
+    std::vector<std::byte> payload;
+    if (!sendMessage(socket, kWireHello, out.bytes()) ||
+        !recvMessage(socket, type, payload) || type != kWireConfig) {
+        throw std::runtime_error("coordinator closed the connection");
+    }
+
+    MessageReader config(payload);
+    SimulationParams p = read_config(config, local);
+    auto jobs = make_jobs(p, false);
+    const simd::Isa isa = simd::activeIsa();
+    std::cout << "Worker of " << local.connect_to << ": " << pool.size()
+              << " threads, SIMD " << simd::isaName(isa)
+              << ", affinity " << affinity.describe() << ", seed "
+              << *p.seed << std::endl;
+
+    std::unique_ptr<ProgressReporter> progress =
+        make_progress_reporter(local, jobs, false);
+    std::vector<std::unique_ptr<WorkerState>> workers(pool.size());
+    const uint32_t batch =
+        kRemoteUnitsPerThread * static_cast<uint32_t>(pool.size());
+    std::vector<WorkUnit> units;
+    std::vector<UnitResult> results;
+    uint64_t blocks = 0;
+    for (;;) {
+        out.clear();
+        out.put(static_cast<uint32_t>(results.size())).put(batch);
+        for (const UnitResult& result : results) out.put(result);
+        if (!sendMessage(socket, kWireResults, out.bytes()) ||
+            !recvMessage(socket, type, payload) || type != kWireWork) {
+            throw std::runtime_error("coordinator closed the connection");
+        }
+        MessageReader work(payload);
+        units.resize(work.get<uint32_t>());
+        if (units.empty()) break;
+        for (WorkUnit& unit : units) {
+            unit = work.get<WorkUnit>();
+            if (unit.job >= jobs.size() ||
+                unit.snr >= jobs[unit.job]->snrs.size()) {
+                throw std::runtime_error("unit for an unknown point");
+            }
+        }
+
+        results.assign(units.size(), UnitResult{});
+        for (size_t k = 0; k < units.size(); ++k) {
+            pool.submit([&, k] {
+                const WorkUnit& unit = units[k];
+                const auto start = std::chrono::steady_clock::now();
+                ModulationJob& job = *jobs[unit.job];
+                const BlockTally tally = run_block(
+                    job, unit.job, unit.snr, unit.block,
+                    workerState(workers, jobs));
+                const auto ns = static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count());
+                // Only for this node's progress; the coordinator counts
+                job.busy_ns[unit.snr].fetch_add(ns,
+                                                std::memory_order_relaxed);
+                job.recordProgress(unit.snr, tally.errors, tally.bits);
+                results[k] = {unit,           tally.errors,
+                              tally.bits,     ns,
+                              tally.weighted, tally.weighted_sq};
+            });
+        }
+        pool.wait();
+        blocks += units.size();
+    }
+    std::cout << "Worker done after " << blocks << " blocks" << std::endl;
+}
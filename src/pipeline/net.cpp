@@ -0,0 +1,157 @@
+#include "qam_simulator/net.hpp"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <utility>
+
+namespace {
+
+/// @brief Largest payload accepted, against corrupt or hostile frames
+constexpr uint32_t kMaxPayload = 64u << 20;
+
+void set_nodelay(int fd) {
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+}
+
+}  // namespace
+
+Socket::~Socket() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+Socket::Socket(Socket&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+
+Socket& Socket::operator=(Socket&& other) noexcept {
+    if (this != &other) {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+Socket Socket::connect(const std::string& host, uint16_t port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    const std::string service = std::to_string(port);
+    if (::getaddrinfo(host.c_str(), service.c_str(), &hints, &found) != 0) {
+        throw std::runtime_error("net: cannot resolve " + host);
+    }
+    for (addrinfo* a = found; a; a = a->ai_next) {
+        const int fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) {
+            ::freeaddrinfo(found);
+            set_nodelay(fd);
+            return Socket(fd);
+        }
+        ::close(fd);
+    }
+    ::freeaddrinfo(found);
+    throw std::runtime_error("net: cannot connect to " + host + ":" + service);
+}
+
+bool Socket::sendAll(const void* data, size_t size) {
+    const auto* p = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t n = ::send(fd_, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool Socket::recvAll(void* data, size_t size, int timeout_ms) {
+    auto* p = static_cast<char*>(data);
+    while (size > 0) {
+        if (timeout_ms >= 0 && !waitReadable(timeout_ms)) return false;
+        const ssize_t n = ::recv(fd_, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool Socket::waitReadable(int timeout_ms) {
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready = 0;
+    do {
+        ready = ::poll(&pfd, 1, timeout_ms);
+    } while (ready < 0 && errno == EINTR);
+    return ready > 0;
+}
+
+size_t Socket::recvSome(void* data, size_t size, int timeout_ms) {
+    if (!waitReadable(timeout_ms)) return 0;
+    ssize_t n = 0;
+    do {
+        n = ::recv(fd_, data, size, 0);
+    } while (n < 0 && errno == EINTR);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+Listener::Listener(uint16_t port) {
+    fd_ = ::socket(AF_INET6, SOCK_STREAM, 0);
+    if (fd_ < 0) throw std::runtime_error("net: cannot create socket");
+    const int one = 1;
+    const int zero = 0;
+    ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    // Accept IPv4 clients on the same socket
+    ::setsockopt(fd_, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+
+    sockaddr_in6 addr{};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(port);
+    if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(fd_, SOMAXCONN) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("net: cannot listen on port " +
+                                 std::to_string(port));
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin6_port);
+}
+
+Listener::~Listener() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+Socket Listener::accept(int timeout_ms) {
+    pollfd pfd{fd_, POLLIN, 0};
+    if (::poll(&pfd, 1, timeout_ms) <= 0) return Socket();
+    const int fd = ::accept(fd_, nullptr, nullptr);
+    if (fd < 0) return Socket();
+    set_nodelay(fd);
+    return Socket(fd);
+}
+
+bool sendMessage(Socket& socket, uint32_t type,
+                 const std::vector<std::byte>& payload) {
+    const uint32_t header[2] = {type, static_cast<uint32_t>(payload.size())};
+    return socket.sendAll(header, sizeof(header)) &&
+           socket.sendAll(payload.data(), payload.size());
+}
+
+bool recvMessage(Socket& socket, uint32_t& type,
+                 std::vector<std::byte>& payload, int timeout_ms) {
+    uint32_t header[2];
+    if (!socket.recvAll(header, sizeof(header), timeout_ms)) return false;
+    if (header[1] > kMaxPayload) return false;
+    type = header[0];
+    payload.resize(header[1]);
+    return socket.recvAll(payload.data(), payload.size(), timeout_ms);
+}
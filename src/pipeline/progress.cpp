@@ -0,0 +1,238 @@
+#include "qam_simulator/progress.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+constexpr int kAcceptTimeoutMs = 200;
+/// @brief Longest wait for the request of a connected scraper
+constexpr int kRequestTimeoutMs = 1000;
+/// @brief Request bytes read at most; the rest is ignored
+constexpr size_t kMaxRequest = 8192;
+
+/// @brief Rate of @p count over @p seconds; 0 for an empty interval
+double per_second(double count, double seconds) {
+    return seconds > 0.0 ? count / seconds : 0.0;
+}
+
+/// @brief Label set of one point, e.g. {modulation="qpsk",snr_db="10"}
+std::string point_labels(const PointProgress& point) {
+    std::ostringstream out;
+    out << "{modulation=\"" << point.modulation << "\",snr_db=\""
+        << point.snr_db << "\"}";
+    return out.str();
+}
+
+void metric_header(std::ostream& out, const char* name, const char* type,
+                   const char* help) {
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' '
+        << type << '\n';
+}
+
+/// @brief Write @p text to @p path through PATH.tmp and a rename
+bool write_status(const std::string& path, const std::string& text) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) return false;
+        out << text;
+        out.flush();
+        if (!out) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+}  // namespace
+
+std::string formatProgressLine(const ProgressSnapshot& now,
+                               const ProgressSnapshot& before) {
+    const double dt = now.elapsed_s - before.elapsed_s;
+    const uint64_t symbols =
+        now.symbols > before.symbols ? now.symbols - before.symbols : 0;
+    size_t finished = 0;
+    const PointProgress* behind = nullptr;
+    for (const PointProgress& point : now.points) {
+        if (point.finished) {
+            ++finished;
+        } else if (!behind || point.errors < behind->errors ||
+                   (point.errors == behind->errors &&
+                    point.bits < behind->bits)) {
+            behind = &point;
+        }
+    }
+
+    std::ostringstream out;
+    out << "Progress " << std::fixed << std::setprecision(0)
+        << now.elapsed_s << " s: " << std::scientific << std::setprecision(3)
+        << per_second(static_cast<double>(symbols), dt) << " symbols/s, "
+        << std::fixed << std::setprecision(1)
+        << per_second(now.busy_s - before.busy_s, dt) << " threads busy";
+    if (!now.points.empty()) {
+        out << ", " << finished << '/' << now.points.size()
+            << " points finished";
+    }
+    if (behind) {
+        out << ", fewest errors: " << behind->label << ' '
+            << std::defaultfloat << std::setprecision(6) << behind->snr_db
+            << " dB with " << behind->errors << " in " << std::scientific
+            << std::setprecision(3) << static_cast<double>(behind->bits)
+            << " bits";
+    }
+    return out.str();
+}
+
+std::string formatProgressMetrics(const ProgressSnapshot& now,
+                                  double symbols_per_s) {
+    std::ostringstream out;
+    out << std::setprecision(12);
+    metric_header(out, "qam_elapsed_seconds", "gauge",
+                  "Seconds since the sweep started");
+    out << "qam_elapsed_seconds " << now.elapsed_s << '\n';
+    metric_header(out, "qam_symbols_total", "counter",
+                  "Symbols of every finished block");
+    out << "qam_symbols_total " << now.symbols << '\n';
+    metric_header(out, "qam_symbols_per_second", "gauge",
+                  "Symbols per second over the last interval");
+    out << "qam_symbols_per_second " << symbols_per_s << '\n';
+    metric_header(out, "qam_busy_seconds_total", "counter",
+                  "Block time summed over all worker threads");
+    out << "qam_busy_seconds_total " << now.busy_s << '\n';
+    if (now.points.empty()) return out.str();
+
+    const auto finished = std::count_if(
+        now.points.begin(), now.points.end(),
+        [](const PointProgress& point) { return point.finished; });
+    metric_header(out, "qam_points", "gauge", "SNR points of the sweep");
+    out << "qam_points " << now.points.size() << '\n';
+    metric_header(out, "qam_points_finished", "gauge",
+                  "SNR points that converged or spent their budget");
+    out << "qam_points_finished " << finished << '\n';
+    metric_header(out, "qam_point_errors_total", "counter",
+                  "Raw bit errors of the finished blocks of an SNR point");
+    for (const PointProgress& point : now.points) {
+        out << "qam_point_errors_total" << point_labels(point) << ' '
+            << point.errors << '\n';
+    }
+    metric_header(out, "qam_point_bits_total", "counter",
+                  "Bits of the finished blocks of an SNR point");
+    for (const PointProgress& point : now.points) {
+        out << "qam_point_bits_total" << point_labels(point) << ' '
+            << point.bits << '\n';
+    }
+    metric_header(out, "qam_point_finished", "gauge",
+                  "1 once an SNR point converged or spent its budget");
+    for (const PointProgress& point : now.points) {
+        out << "qam_point_finished" << point_labels(point) << ' '
+            << (point.finished ? 1 : 0) << '\n';
+    }
+    return out.str();
+}
+
+ProgressReporter::ProgressReporter(const ProgressOptions& options,
+                                   Collect collect)
+    : options_(options), collect_(std::move(collect)), start_(Clock::now()) {
+    if (options_.port) listener_ = std::make_unique<Listener>(*options_.port);
+    take(first_);
+    last_ = first_;
+    thread_ = std::thread(&ProgressReporter::loop, this);
+    if (listener_) server_ = std::thread(&ProgressReporter::serve, this);
+}
+
+ProgressReporter::~ProgressReporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    thread_.join();
+    if (server_.joinable()) server_.join();
+}
+
+uint16_t ProgressReporter::port() const noexcept {
+    return listener_ ? listener_->port() : 0;
+}
+
+void ProgressReporter::take(ProgressSnapshot& out) const {
+    collect_(out);
+    out.elapsed_s =
+        std::chrono::duration<double>(Clock::now() - start_).count();
+}
+
+void ProgressReporter::publish(bool final) {
+    ProgressSnapshot now;
+    take(now);
+    // The last interval is cut short; average the final line over the run
+    const ProgressSnapshot& before = final ? first_ : last_;
+    const double dt = now.elapsed_s - before.elapsed_s;
+    if (dt > 0.0 && now.symbols >= before.symbols) {
+        rate_ = static_cast<double>(now.symbols - before.symbols) / dt;
+    }
+    if (options_.lines) {
+        // One write per line, so lines of other threads do not split it
+        std::cerr << formatProgressLine(now, before) + "\n" << std::flush;
+    }
+    if (!options_.status_file.empty() &&
+        !write_status(options_.status_file,
+                      formatProgressMetrics(now, rate_.load()))) {
+        std::cerr << "Could not write status file " << options_.status_file
+                  << "\n";
+    }
+    last_ = std::move(now);
+}
+
+void ProgressReporter::loop() {
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options_.interval_s));
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        const bool stopping =
+            stop_cv_.wait_for(lock, interval, [this] { return stop_; });
+        lock.unlock();
+        publish(stopping);
+        if (stopping) return;
+        lock.lock();
+    }
+}
+
+void ProgressReporter::serve() {
+    std::string request;
+    char buffer[1024];
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stop_) return;
+        }
+        Socket socket = listener_->accept(kAcceptTimeoutMs);
+        if (!socket.valid()) continue;
+        // Read the request head; the path and headers do not matter
+        request.clear();
+        while (request.find("\r\n\r\n") == std::string::npos &&
+               request.size() < kMaxRequest) {
+            const size_t n =
+                socket.recvSome(buffer, sizeof(buffer), kRequestTimeoutMs);
+            if (n == 0) break;
+            request.append(buffer, n);
+        }
+        std::string status = "405 Method Not Allowed";
+        std::string body;
+        if (request.starts_with("GET ")) {
+            ProgressSnapshot now;
+            take(now);
+            status = "200 OK";
+            body = formatProgressMetrics(now, rate_.load());
+        }
+        const std::string head =
+            "HTTP/1.0 " + status +
+            "\r\nContent-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: " +
+            std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n";
+        if (socket.sendAll(head.data(), head.size())) {
+            socket.sendAll(body.data(), body.size());
+        }
+    }
+}
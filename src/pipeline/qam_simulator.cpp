@@ -1,160 +1,972 @@
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <random>
+#include <sstream>
+#include <span>
 #include <string>
-#include <thread>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-#include "qam_simulator/csv_writer.hpp"
+#include "qam_simulator/checkpoint.hpp"
 #include "qam_simulator/demodulator_qam.hpp"
+#include "qam_simulator/distributed.hpp"
+#include "qam_simulator/gpu_backend.hpp"
+#include "qam_simulator/instrumentation.hpp"
 #include "qam_simulator/modulator_qam.hpp"
 #include "qam_simulator/noise.hpp"
+#include "qam_simulator/packed_bits.hpp"
 #include "qam_simulator/pipeline.hpp"
+#include "qam_simulator/progress.hpp"
+#include "qam_simulator/results_sink.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+#include "qam_simulator/simd.hpp"
+#include "qam_simulator/stage_pipeline.hpp"
+#include "qam_simulator/sweep.hpp"
+#include "qam_simulator/thread_pool.hpp"
+
+/**
+ * @brief Fills a caller-provided buffer with random bits.
+ */
+void generateRandomBits(std::span<uint8_t> out, std::mt19937& rng) {
+    std::uniform_int_distribution<int> d(0, 1);
+    for (auto& bit : out) bit = static_cast<uint8_t>(d(rng));
+}
+
+/**
+ * @brief Fills a packed bitstream with random bits.
+ *
+ * Draws the same sequence as the unpacked overload.
+ */
+void generateRandomBits(PackedBits& out, std::mt19937& rng) {
+    std::uniform_int_distribution<int> d(0, 1);
+    auto words = out.words();
+    size_t remaining = out.size();
+    for (auto& word : words) {
+        const size_t n = std::min<size_t>(remaining, PackedBits::kWordBits);
+        uint64_t w = 0;
+        for (size_t k = 0; k < n; ++k) {
+            w |= static_cast<uint64_t>(d(rng))
+                 << (PackedBits::kWordBits - 1 - k);
+        }
+        word = w;
+        remaining -= n;
+    }
+}
 
 /**
  * @brief Generates a vector of random bits.
  */
 std::vector<uint8_t> generateRandomBits(size_t n, std::mt19937& rng) {
     std::vector<uint8_t> v(n);
-    std::uniform_int_distribution<int> d(0, 1);
-    for (size_t i = 0; i < n; ++i) v[i] = static_cast<uint8_t>(d(rng));
+    generateRandomBits(v, rng);
     return v;
 }
 
+/**
+ * @brief Fills a packed bitstream straight from 64-bit generator output.
+ */
+void generateRandomBits(PackedBitsView out, Xoshiro256& rng) {
+    auto words = out.words();
+    for (auto& word : words) word = rng();
+    const size_t tail = out.size() % PackedBits::kWordBits;
+    if (tail != 0) {
+        words.back() &= ~uint64_t{0} << (PackedBits::kWordBits - tail);
+    }
+}
+
+/**
+ * @brief Fills one bit per byte, MSB of each draw first.
+ */
+void generateRandomBits(std::span<uint8_t> out, Xoshiro256& rng) {
+    for (size_t i = 0; i < out.size(); i += PackedBits::kWordBits) {
+        const uint64_t w = rng();
+        const size_t n = std::min(PackedBits::kWordBits, out.size() - i);
+        for (size_t k = 0; k < n; ++k) {
+            out[i + k] = static_cast<uint8_t>(
+                (w >> (PackedBits::kWordBits - 1 - k)) & 1);
+        }
+    }
+}
+
+/**
+ * @brief Prints the command-line synopsis and exits.
+ */
+[[noreturn]] static void usage(const char* prog) {
+    std::cerr << "Usage: " << prog
+              << " <snr_start> <snr_end> <snr_step> <num_threads> "
+                 "<bits_per_thread> <iterations_per_snr> [options]\n"
+                 "Options:\n"
+                 "  --noise=E              Gaussian noise engine: std, "
+                 "ziggurat (default), or pool\n"
+                 "                         (precomputed samples; fast, "
+                 "coarse below BER ~1e-3)\n"
+                 "  --target-errors=N      Stop an SNR point after N bit "
+                 "errors\n"
+                 "  --max-rel-ci=X         Stop an SNR point once the "
+                 "relative 95% CI half-width <= X\n"
+                 "  --max-bits=N           Bit budget per SNR point "
+                 "(default: the fixed workload)\n"
+                 "  --kernel=K             Block kernel: fused (default), "
+                 "staged, or pipelined\n"
+                 "                         (one thread per stage, ignores "
+                 "num_threads)\n"
+                 "  --block-bits=N         Bits streamed through the kernel "
+                 "at a time (default: 1048576)\n"
+                 "  --ring-depth=N         Frames per ring of the pipelined "
+                 "kernel (default: 4)\n"
+                 "  --instr-json=PATH      Instrumentation JSON output "
+                 "(instrumented builds only)\n"
+                 "  --seed=N               Master seed (default: random, "
+                 "printed); with the same\n"
+                 "                         block budget the output does not "
+                 "depend on num_threads\n"
+                 "  --replay=M:SNR:BLOCK   Run only block BLOCK of SNR index "
+                 "SNR of M-QAM (needs --seed)\n"
+                 "  --checkpoint=PATH      Save per-point progress to PATH "
+                 "periodically\n"
+                 "  --checkpoint-every=S   Seconds between checkpoints "
+                 "(default: 60)\n"
+                 "  --resume=PATH          Continue from checkpoint PATH if "
+                 "it exists, and keep\n"
+                 "                         checkpointing to it\n"
+                 "  --results=F            Results backend: csv (default), "
+                 "binary, or both\n"
+                 "  --results-path=PATH    Binary results file "
+                 "(default: qam_results.qbr)\n"
+                 "  --serve=PORT           Coordinate a distributed sweep: "
+                 "hand work units to\n"
+                 "                         workers connecting on PORT\n"
+                 "  --lease=S              Seconds a worker has to return "
+                 "its units before they\n"
+                 "                         go to other workers (default: "
+                 "600)\n"
+                 "  --connect=HOST:PORT    Run as a worker of the coordinator "
+                 "at HOST:PORT\n"
+                 "  --payload=P            independent (default) or shared: "
+                 "one payload per block\n"
+                 "                         fed to every modulation order\n"
+                 "  --affinity=A           Pin workers: none (default), core "
+                 "(one CPU each) or\n"
+                 "                         node (one NUMA node each), "
+                 "spread across nodes\n"
+                 "  --orders=M,...         Constellation orders to sweep, any "
+                 "of 4, 16, 64, 256,\n"
+                 "                         1024, 4096 (default: 4,16,64)\n"
+                 "  --importance=DB        Importance sampling: draw noise DB "
+                 "dB stronger and weight\n"
+                 "                         errors by their likelihood ratio "
+                 "(for BER << 1e-6)\n"
+                 "  --backend=B            cpu (default) or cuda: run the "
+                 "blocks on a GPU (builds\n"
+                 "                         with QAM_ENABLE_CUDA; "
+                 "statistically equal to cpu)\n"
+                 "  --progress=S           Print the counts and symbols/s to "
+                 "stderr every S seconds\n"
+                 "  --status-file=PATH     Rewrite PATH with Prometheus-style "
+                 "metrics every interval\n"
+                 "  --metrics-port=PORT    Serve the same metrics over HTTP "
+                 "on PORT\n";
+    std::exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief Parses "M:SNR_INDEX:BLOCK" into a BlockRef.
+ *
+ * @throws std::invalid_argument if a field is missing or not a number
+ */
+static BlockRef parse_block_ref(const std::string& value) {
+    const size_t a = value.find(':');
+    const size_t b = a == std::string::npos ? a : value.find(':', a + 1);
+    if (b == std::string::npos) {
+        throw std::invalid_argument("expected M:SNR_INDEX:BLOCK");
+    }
+    BlockRef ref;
+    ref.levels = std::stoi(value.substr(0, a));
+    ref.snr_index = std::stoull(value.substr(a + 1, b - a - 1));
+    ref.block = std::stoull(value.substr(b + 1));
+    return ref;
+}
+
+/**
+ * @brief Parses a comma-separated list of distinct constellation orders.
+ *
+ * @throws std::invalid_argument on an empty list, an unsupported order or
+ * a repeated one
+ */
+static std::vector<int> parse_orders(const std::string& value) {
+    std::vector<int> orders;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        const int levels = std::stoi(item);
+        if (!isSquareQamOrder(levels)) {
+            throw std::invalid_argument("order " + item + ": " +
+                                        kUnsupportedQamOrder);
+        }
+        if (std::find(orders.begin(), orders.end(), levels) != orders.end()) {
+            throw std::invalid_argument("order " + item + " listed twice");
+        }
+        orders.push_back(levels);
+    }
+    if (orders.empty()) throw std::invalid_argument("no orders given");
+    return orders;
+}
+
 /**
  * @brief Parses command-line arguments into a SimulationParams structure.
  */
 SimulationParams parse_args(int argc, char** argv) {
-    if (argc < 7) {
-        std::cerr << "Usage: " << argv[0]
-                  << " <snr_start> <snr_end> <snr_step> <num_threads> "
-                     "<bits_per_thread> <iterations_per_snr>\n";
-        std::exit(EXIT_FAILURE);
+    if (argc < 7) usage(argv[0]);
+    SimulationParams p{};
+    p.snr_start = std::stod(argv[1]);
+    p.snr_end = std::stod(argv[2]);
+    p.snr_step = std::stod(argv[3]);
+    p.num_threads = std::stoi(argv[4]);
+    p.bits_per_thread = std::stoull(argv[5]);
+    p.iterations_per_snr = std::stoull(argv[6]);
+
+    for (int i = 7; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+        auto eq = arg.find('=');
+        if (!arg.starts_with("--") || eq == std::string_view::npos) {
+            usage(argv[0]);
+        }
+        std::string_view key = arg.substr(2, eq - 2);
+        std::string value(arg.substr(eq + 1));
+        try {
+            if (key == "noise") {
+                p.noise_engine = parseNoiseEngineKind(value);
+            } else if (key == "target-errors") {
+                p.stopping.target_errors = std::stoull(value);
+            } else if (key == "max-rel-ci") {
+                p.stopping.max_rel_ci = std::stod(value);
+            } else if (key == "max-bits") {
+                p.stopping.max_bits = std::stoull(value);
+            } else if (key == "instr-json") {
+                p.instrumentation_json = value;
+            } else if (key == "ring-depth") {
+                p.ring_depth = std::stoull(value);
+            } else if (key == "block-bits") {
+                p.block_bits = std::stoull(value);
+            } else if (key == "seed") {
+                p.seed = std::stoull(value);
+            } else if (key == "checkpoint") {
+                p.checkpoint_path = value;
+            } else if (key == "checkpoint-every") {
+                p.checkpoint_interval_s = std::stod(value);
+            } else if (key == "resume") {
+                p.checkpoint_path = value;
+                p.resume = true;
+            } else if (key == "results") {
+                if (value == "csv") {
+                    p.results_format = ResultsFormat::Csv;
+                } else if (value == "binary") {
+                    p.results_format = ResultsFormat::Binary;
+                } else if (value == "both") {
+                    p.results_format = ResultsFormat::Both;
+                } else {
+                    throw std::invalid_argument("unknown format " + value);
+                }
+            } else if (key == "serve") {
+                const unsigned long port = std::stoul(value);
+                if (port > 65535) throw std::out_of_range("port " + value);
+                p.serve_port = static_cast<uint16_t>(port);
+            } else if (key == "lease") {
+                p.lease_s = std::stod(value);
+                if (!(p.lease_s > 0.0)) {
+                    throw std::invalid_argument("seconds must be > 0");
+                }
+            } else if (key == "connect") {
+                if (value.rfind(':') == std::string::npos) {
+                    throw std::invalid_argument("expected HOST:PORT");
+                }
+                p.connect_to = value;
+            } else if (key == "affinity") {
+                p.affinity = parseAffinityMode(value);
+            } else if (key == "orders") {
+                p.orders = parse_orders(value);
+            } else if (key == "backend") {
+                if (value == "cpu") {
+                    p.backend = ComputeBackend::Cpu;
+                } else if (value == "cuda") {
+                    p.backend = ComputeBackend::Cuda;
+                } else {
+                    throw std::invalid_argument("unknown backend " + value);
+                }
+            } else if (key == "importance") {
+                p.importance_bias_db = std::stod(value);
+                if (!(p.importance_bias_db >= 0.0) ||
+                    !std::isfinite(p.importance_bias_db)) {
+                    throw std::invalid_argument("bias must be >= 0 dB");
+                }
+            } else if (key == "payload") {
+                if (value == "shared") {
+                    p.shared_payload = true;
+                } else if (value == "independent") {
+                    p.shared_payload = false;
+                } else {
+                    throw std::invalid_argument("unknown payload " + value);
+                }
+            } else if (key == "progress") {
+                p.progress_interval_s = std::stod(value);
+                if (!(p.progress_interval_s >= 0.0)) {
+                    throw std::invalid_argument("seconds must be >= 0");
+                }
+            } else if (key == "status-file") {
+                p.status_file = value;
+            } else if (key == "metrics-port") {
+                const unsigned long port = std::stoul(value);
+                if (port > 65535) throw std::out_of_range("port " + value);
+                p.metrics_port = static_cast<uint16_t>(port);
+            } else if (key == "results-path") {
+                p.results_path = value;
+            } else if (key == "replay") {
+                p.replay = parse_block_ref(value);
+            } else if (key == "kernel") {
+                if (value == "fused") {
+                    p.kernel = BlockKernel::Fused;
+                } else if (value == "staged") {
+                    p.kernel = BlockKernel::Staged;
+                } else if (value == "pipelined") {
+                    p.kernel = BlockKernel::Pipelined;
+                } else {
+                    throw std::invalid_argument("unknown kernel " + value);
+                }
+            } else {
+                usage(argv[0]);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Invalid value for --" << key << ": " << e.what()
+                      << "\n";
+            usage(argv[0]);
+        }
     }
-    return {
-        std::stod(argv[1]),    // snr_start
-        std::stod(argv[2]),    // snr_end
-        std::stod(argv[3]),    // snr_step
-        std::stoi(argv[4]),    // num_threads
-        std::stoull(argv[5]),  // bits_per_thread
-        std::stoull(argv[6])   // iterations_per_snr
-    };
+    if (p.replay && !p.seed) {
+        std::cerr << "--replay needs the --seed of the run to replay\n";
+        usage(argv[0]);
+    }
+    if (p.importance_bias_db > 0.0 && p.kernel == BlockKernel::Pipelined) {
+        std::cerr << "--importance is not supported by the pipelined "
+                     "kernel\n";
+        usage(argv[0]);
+    }
+    if (p.backend == ComputeBackend::Cuda) {
+        if (!gpu::enabled()) {
+            std::cerr << "--backend=cuda needs a build configured with "
+                         "-DQAM_ENABLE_CUDA=ON\n";
+            std::exit(EXIT_FAILURE);
+        }
+        if (p.importance_bias_db > 0.0 || p.shared_payload ||
+            p.serve_port || !p.connect_to.empty()) {
+            std::cerr << "--backend=cuda does not support --importance, "
+                         "--payload=shared, --serve or --connect\n";
+            usage(argv[0]);
+        }
+    }
+    return p;
 }
 
+namespace {
+
 /**
- * @brief Simulates a QAM modulation system for a given M-ary constellation.
+ * @brief Hands out (modulation, SNR, block) work units on a work-stealing
+ * pool until every SNR point of every job has converged or spent its
+ * budget.
  *
- * @param modulation_levels Number of constellation points (e.g., 4 for QPSK, 16
- * for 16-QAM, etc.)
- * @param name Name of the modulation scheme for output file naming.
- * @param p Simulation parameters.
- */
-void simulate_mod(int modulation_levels, const std::string& name,
-                  const SimulationParams& p) {
-    CsvWriter writer("ber_" + name + ".csv");
-    writer.write_header("SNR_dB,BER");
-    std::cout << "=== " << name << " ===\n";
-
-    std::vector<double> snrs;
-    for (double snr = p.snr_start; snr <= p.snr_end; snr += p.snr_step)
-        snrs.push_back(snr);
-
-    std::vector<std::atomic<uint64_t>> errors(snrs.size());
-    std::vector<std::atomic<uint64_t>> bits(snrs.size());
-
-    for (size_t i = 0; i < snrs.size(); ++i) {
-        errors[i] = 0;
-        bits[i] = 0;
-    }
-
-    std::vector<std::thread> threads;
-    threads.reserve(p.num_threads);
-    ModulatorQAM mod(modulation_levels);
-    DemodulatorQAM demod(modulation_levels);
-
-    for (int t_idx = 0; t_idx < p.num_threads; ++t_idx) {
-        unsigned seed =
-            static_cast<unsigned>(std::chrono::high_resolution_clock::now()
-                                      .time_since_epoch()
-                                      .count()) +
-            t_idx;
-
-        threads.emplace_back([&, seed]() {
-            std::mt19937 rng(seed);
-            for (size_t i = 0; i < snrs.size(); ++i) {
-                NoiseAdder noise(snrs[i]);
-
-                for (size_t iter = 0; iter < p.iterations_per_snr; ++iter) {
-                    auto b = generateRandomBits(p.bits_per_thread, rng);
-                    auto s = mod.modulate(b);
-                    auto n = noise.addNoise(s);
-                    auto r = demod.demodulate_hard(n);
-
-                    uint64_t err = 0;
-                    for (size_t j = 0; j < b.size(); ++j)
-                        if (b[j] != r[j]) ++err;
-
-                    errors[i] += err;
-                    bits[i] += b.size();
+ * A bounded number of units is in flight. Whenever one finishes, the next
+ * unit goes to the next open point in round-robin order, so compute freed
+ * by converged points flows to the points that are still running, and no
+ * modulation waits for another to finish. Fixed-workload points sum their
+ * blocks in per-worker counters; adaptive and checkpointed points fold them
+ * in block order (see PointLedger), so both give the same totals for any
+ * schedule.
+ *
+ * With a shared payload a unit is an (SNR, block) pair instead, run for
+ * every order still open at that point (see run_shared_block()), and
+ * blocks are claimed from one counter per SNR point.
+ */
+class SweepScheduler {
+   public:
+    SweepScheduler(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                   int num_threads, Checkpointer* checkpointer)
+        : jobs_(jobs),
+          checkpointer_(checkpointer),
+          affinity_(jobs_.empty() ? AffinityMode::None
+                                  : jobs_.front()->params.affinity,
+                    CpuTopology::host()),
+          pool_(num_threads, [this](int w) { affinity_.pin(w); }),
+          workers_(pool_.size()),
+          shared_(!jobs_.empty() && jobs_.front()->params.shared_payload) {
+        if (shared_) {
+            // Every job has the same SNR points and block budget; on
+            // resume, start from the least advanced open order
+            const size_t snrs = jobs_.front()->snrs.size();
+            shared_next_ = std::vector<std::atomic<uint64_t>>(snrs);
+            for (size_t i = 0; i < snrs; ++i) {
+                uint64_t next = jobs_.front()->max_blocks;
+                for (const auto& job : jobs_) {
+                    if (!job->converged[i]) {
+                        next = std::min(next, job->issued[i].load());
+                    }
+                }
+                shared_next_[i] = next;
+                points_.push_back({0, i});
+            }
+            return;
+        }
+        // Interleave jobs so the cheap and expensive orders share the pool
+        size_t max_snrs = 0;
+        for (const auto& job : jobs_)
+            max_snrs = std::max(max_snrs, job->snrs.size());
+        for (size_t i = 0; i < max_snrs; ++i) {
+            for (size_t j = 0; j < jobs_.size(); ++j) {
+                if (i < jobs_[j]->snrs.size()) points_.push_back({j, i});
+            }
+        }
+    }
+
+    /**
+     * @brief Run the sweep to completion.
+     */
+    void run() {
+        const size_t in_flight = kUnitsPerWorker * workers_.size();
+        for (size_t k = 0; k < in_flight; ++k) dispatch();
+        pool_.wait();
+        reduce();
+    }
+
+   private:
+    static constexpr size_t kUnitsPerWorker = 4;
+
+    struct Point {
+        size_t job_index;
+        size_t snr_index;
+    };
+
+    /// @brief Queue one work unit
+    void dispatch() {
+        pool_.submit([this] { runUnit(); });
+    }
+
+    /**
+     * @brief Run one block of the next open point, then queue the next unit.
+     *
+     * The block is claimed when the unit starts, not when it is queued:
+     * workers pop their own deque LIFO, so a unit queued early can wait
+     * until the end of the sweep, and must not hold a low block index that
+     * in-order counting is waiting for meanwhile.
+     */
+    void runUnit() {
+        if (shared_) {
+            runSharedUnit();
+            return;
+        }
+        for (size_t k = 0; k < points_.size(); ++k) {
+            const Point point = points_[cursor_.fetch_add(1) % points_.size()];
+            ModulationJob& job = *jobs_[point.job_index];
+            uint64_t block = 0;
+            if (!job.reserveBlock(point.snr_index, block)) continue;
+            WorkerState& worker = workerState(workers_, jobs_);
+            const auto start = std::chrono::steady_clock::now();
+            const BlockTally tally = run_block(job, point.job_index,
+                                               point.snr_index, block, worker);
+            job.busy_ns[point.snr_index].fetch_add(
+                static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start)
+                        .count()),
+                std::memory_order_relaxed);
+            job.recordProgress(point.snr_index, tally.errors, tally.bits);
+            if (job.ordered) {
+                job.commitBlock(point.snr_index, block, tally);
+                if (checkpointer_) checkpointer_->maybeWrite();
+            } else {
+                worker.counters[point.job_index][point.snr_index].add(
+                    tally.errors, tally.bits);
+            }
+            dispatch();
+            return;
+        }
+    }
+
+    /**
+     * @brief Run the next block of the next open SNR point for every order
+     * still open there, then queue the next unit.
+     */
+    void runSharedUnit() {
+        const uint64_t max_blocks = jobs_.front()->max_blocks;
+        for (size_t k = 0; k < points_.size(); ++k) {
+            const size_t i =
+                points_[cursor_.fetch_add(1) % points_.size()].snr_index;
+            if (shared_next_[i].load(std::memory_order_relaxed) >=
+                max_blocks) {
+                continue;
+            }
+            WorkerState& worker = workerState(workers_, jobs_);
+            worker.open.clear();
+            for (size_t j = 0; j < jobs_.size(); ++j) {
+                if (!jobs_[j]->converged[i].load(std::memory_order_relaxed)) {
+                    worker.open.push_back(j);
+                }
+            }
+            if (worker.open.empty()) continue;
+            const uint64_t block = shared_next_[i].fetch_add(1);
+            if (block >= max_blocks) continue;
+
+            run_shared_block(jobs_, i, block, worker);
+            for (size_t j : worker.open) {
+                ModulationJob& job = *jobs_[j];
+                job.busy_ns[i].fetch_add(worker.job_ns[j],
+                                         std::memory_order_relaxed);
+                job.recordProgress(i, worker.tallies[j].errors,
+                                   worker.tallies[j].bits);
+                if (job.ordered) {
+                    job.commitBlock(i, block, worker.tallies[j]);
+                } else {
+                    worker.counters[j][i].add(worker.tallies[j].errors,
+                                              worker.tallies[j].bits);
+                }
+            }
+            if (checkpointer_) checkpointer_->maybeWrite();
+            dispatch();
+            return;
+        }
+    }
+
+    /// @brief Fold the per-worker accumulators into the job totals
+    void reduce() {
+        for (size_t j = 0; j < jobs_.size(); ++j) {
+            ModulationJob& job = *jobs_[j];
+            for (size_t i = 0; i < job.snrs.size(); ++i) {
+                job.errors[i] += job.ledgers[i].errors;
+                job.bits[i] += job.ledgers[i].bits;
+                job.weighted[i] += job.ledgers[i].weighted;
+                job.weighted_sq[i] += job.ledgers[i].weighted_sq;
+            }
+            for (const auto& w : workers_) {
+                if (!w) continue;  // Never ran a unit
+                for (size_t i = 0; i < job.snrs.size(); ++i) {
+                    job.errors[i] += w->counters[j][i].errors.load();
+                    job.bits[i] += w->counters[j][i].bits.load();
+                }
+                if (w->scratch[j]) {
+                    job.steady_allocations += w->scratch[j]->allocations;
                 }
             }
-        });
+        }
+    }
+
+    std::vector<std::unique_ptr<ModulationJob>>& jobs_;
+    Checkpointer* checkpointer_;  ///< Null unless checkpointing
+    AffinityPlan affinity_;
+    ThreadPool pool_;
+    std::vector<std::unique_ptr<WorkerState>> workers_;  ///< Built lazily
+    std::vector<Point> points_;
+    std::atomic<size_t> cursor_{0};
+    bool shared_;  ///< One payload for every job (see run_shared_block())
+    /// @brief Next block of each SNR point, in shared-payload mode
+    std::vector<std::atomic<uint64_t>> shared_next_;
+};
+
+/**
+ * @brief Runs every SNR point of @p jobs on the stage-parallel chain, one
+ * point after another.
+ *
+ * Checkpoints are taken between points. A point saved part-way by another
+ * kernel is rerun from its first block.
+ */
+void run_pipelined(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                   Checkpointer* checkpointer) {
+    for (auto& job_ptr : jobs) {
+        ModulationJob& job = *job_ptr;
+        StagePipeline chain(job.mod, job.demod, job.params.noise_engine,
+                            chunk_bits(job),
+                            std::max<size_t>(1, job.params.ring_depth));
+        for (size_t i = 0; i < job.snrs.size(); ++i) {
+            if (job.finished(i)) {
+                const PointCheckpoint saved = job.savePoint(i);
+                job.errors[i] = saved.errors;
+                job.bits[i] = saved.bits;
+                continue;
+            }
+            StagePipelineResult r =
+                chain.run(job.snrs[i], job.params.bits_per_thread,
+                          job.max_blocks, job.params.stopping,
+                          job.streamKey(i));
+            job.errors[i] = r.errors;
+            job.bits[i] = r.bits;
+            job.busy_ns[i] = static_cast<uint64_t>(r.wall_s * 1e9);
+            job.restorePoint(i, {r.bits / job.params.bits_per_thread,
+                                 r.errors, r.bits});
+            if (checkpointer) checkpointer->maybeWrite();
+            for (size_t s = 0; s < job.stages.size(); ++s) {
+                job.stages[s].name = r.stages[s].name;
+                job.stages[s] += r.stages[s];
+            }
+            job.stage_wall_s += r.wall_s;
+        }
+    }
+}
+
+/**
+ * @brief Runs every (modulation, SNR, block) work unit of @p jobs.
+ */
+void run_jobs(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+              int num_threads, Checkpointer* checkpointer) {
+    if (!jobs.empty() &&
+        jobs.front()->params.backend == ComputeBackend::Cuda) {
+        gpu::runSweep(jobs, checkpointer);
+        return;
+    }
+    if (!jobs.empty() &&
+        jobs.front()->params.kernel == BlockKernel::Pipelined) {
+        run_pipelined(jobs, checkpointer);
+        return;
+    }
+    SweepScheduler scheduler(jobs, num_threads, checkpointer);
+    scheduler.run();
+}
+
+/**
+ * @brief Prints per-stage throughput and wait times of the pipelined kernel.
+ */
+void report_stages(const ModulationJob& job) {
+    std::cout << "Stage        Frames    Mbit/s   Busy%  Starved%  "
+                 "Blocked%\n";
+    const double wall = std::max(job.stage_wall_s, 1e-9);
+    for (const StageStats& st : job.stages) {
+        const double mbps =
+            st.busy_s > 0 ? static_cast<double>(st.bits) / st.busy_s / 1e6
+                          : 0.0;
+        std::cout << std::left << std::setw(12) << st.name << std::right
+                  << std::setw(7) << st.frames << std::fixed
+                  << std::setprecision(1) << std::setw(10) << mbps
+                  << std::setw(8) << 100.0 * st.busy_s / wall << std::setw(10)
+                  << 100.0 * st.starved_s / wall << std::setw(10)
+                  << 100.0 * st.blocked_s / wall << "\n"
+                  << std::defaultfloat;
     }
+}
 
-    for (auto& th : threads) th.join();
+/**
+ * @brief Passes the points of a finished job to @p sink and prints the
+ * per-SNR table.
+ */
+void report(const ModulationJob& job, ResultsSink& sink) {
+    std::cout << "=== " << job.name << " ===\n";
 
-    for (size_t i = 0; i < snrs.size(); ++i) {
-        double ber =
-            static_cast<double>(errors[i]) / static_cast<double>(bits[i]);
-        writer.write_row(snrs[i], ber);
-        std::cout << "SNR=" << std::fixed << std::setprecision(12) << snrs[i]
-                  << " dB, BER=" << ber << ", Errors=" << errors[i]
-                  << ", Bits=" << bits[i] << "\n";
+    for (size_t i = 0; i < job.snrs.size(); ++i) {
+        const double bits = static_cast<double>(job.bits[i]);
+        // Importance sampling reports the weighted estimate; Errors stays
+        // the raw count under the biased channel
+        const double ber = job.importance()
+                               ? job.weighted[i] / bits
+                               : static_cast<double>(job.errors[i]) / bits;
+        const double variance =
+            job.importance()
+                ? weighted_ber_variance(job.weighted[i], job.weighted_sq[i],
+                                        job.bits[i],
+                                        job.mod.getBitsPerSymbol())
+                : ber * (1.0 - ber) / bits;
+        const double rel_ci95 = job.relCi95(job.errors[i], job.bits[i],
+                                            job.weighted[i],
+                                            job.weighted_sq[i]);
+        ResultRow row;
+        row.modulation = job.name;
+        row.levels = job.levels;
+        row.snr_db = job.snrs[i];
+        row.errors = job.errors[i];
+        row.bits = job.bits[i];
+        row.ber = ber;
+        row.ber_variance = variance;
+        row.rel_ci95 = rel_ci95;
+        row.seconds = static_cast<double>(job.busy_ns[i].load()) * 1e-9;
+        sink.add(row);
+        std::cout << "SNR=" << std::fixed << std::setprecision(12)
+                  << job.snrs[i] << " dB, BER=" << ber
+                  << ", Errors=" << job.errors[i] << ", Bits=" << job.bits[i]
+                  << std::defaultfloat << std::setprecision(3) << ", RelCI95="
+                  << rel_ci95;
+        if (job.importance()) std::cout << ", BERVar=" << variance;
+        std::cout << "\n";
     }
     std::cout << std::defaultfloat;
+    // The device kernel has no host allocations or stages to report
+    if (job.params.backend == ComputeBackend::Cuda) return;
+    if (job.params.kernel == BlockKernel::Pipelined) {
+        report_stages(job);
+    } else {
+        std::cout << "Heap allocations in the block kernel: "
+                  << job.steady_allocations << "\n";
+    }
 }
 
 /**
- * @brief Runs all simulations for different QAM modulation schemes.
+ * @brief The sink(s) selected by @p p.
+ */
+std::unique_ptr<ResultsSink> make_results_sink(const SimulationParams& p) {
+    std::vector<std::unique_ptr<ResultsSink>> sinks;
+    if (p.results_format != ResultsFormat::Binary) {
+        sinks.push_back(std::make_unique<CsvResultsSink>());
+    }
+    if (p.results_format != ResultsFormat::Csv) {
+        sinks.push_back(std::make_unique<BinaryResultsSink>(p.results_path));
+    }
+    if (sinks.size() == 1) return std::move(sinks.front());
+    return std::make_unique<TeeResultsSink>(std::move(sinks));
+}
+
+/**
+ * @brief Name of a block kernel, as accepted by --kernel=.
+ */
+const char* kernel_name(BlockKernel kernel) {
+    switch (kernel) {
+        case BlockKernel::Fused:
+            return "fused";
+        case BlockKernel::Staged:
+            return "staged";
+        case BlockKernel::Pipelined:
+            return "pipelined";
+    }
+    return "?";
+}
+
+/**
+ * @brief The orders of @p p, space-separated so that the list stays one
+ * field of the CSV metadata.
+ */
+std::string orders_list(const SimulationParams& p) {
+    std::string list;
+    for (int levels : p.orders) {
+        if (!list.empty()) list += ' ';
+        list += std::to_string(levels);
+    }
+    return list;
+}
+
+/**
+ * @brief The parameters of a run, for the results metadata.
  */
-void run_all_simulations(const SimulationParams& p) {
-    auto adjust_bits = [&](size_t bits_per_symbol) {
-        size_t rem = p.bits_per_thread % bits_per_symbol;
-        return rem == 0 ? p.bits_per_thread
-                        : p.bits_per_thread + (bits_per_symbol - rem);
+RunMetadata run_metadata(const SimulationParams& p, double wall_s) {
+    auto str = [](auto value) {
+        std::ostringstream os;
+        os << std::setprecision(17) << value;
+        return os.str();
     };
+    return {{"seed", str(p.seed.value_or(0))},
+            {"snr_start", str(p.snr_start)},
+            {"snr_end", str(p.snr_end)},
+            {"snr_step", str(p.snr_step)},
+            {"num_threads", str(p.num_threads)},
+            {"bits_per_thread", str(p.bits_per_thread)},
+            {"iterations_per_snr", str(p.iterations_per_snr)},
+            {"noise_engine", makeNoiseEngine(p.noise_engine, 0)->name()},
+            {"kernel", kernel_name(p.kernel)},
+            {"block_bits", str(p.block_bits)},
+            {"payload", p.shared_payload ? "shared" : "independent"},
+            {"affinity", affinityModeName(p.affinity)},
+            {"orders", orders_list(p)},
+            {"importance_db", str(p.importance_bias_db)},
+            {"backend",
+             p.backend == ComputeBackend::Cuda ? "cuda" : "cpu"},
+            {"target_errors", str(p.stopping.target_errors)},
+            {"max_rel_ci", str(p.stopping.max_rel_ci)},
+            {"max_bits", str(p.stopping.max_bits)},
+            {"simd", simd::isaName(simd::activeIsa())},
+            {"wall_s", str(wall_s)}};
+}
+
+/**
+ * @brief The master seed of @p p, or a fresh one from std::random_device.
+ */
+uint64_t resolve_seed(const SimulationParams& p) {
+    if (p.seed) return *p.seed;
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+}
+
+/**
+ * @brief Runs the single block @p ref of @p job and prints its counts.
+ *
+ * Gives the same counts as that block had in the sweep it came from.
+ */
+void replay_block(ModulationJob& job, const std::string& label,
+                  const BlockRef& ref) {
+    if (ref.snr_index >= job.snrs.size()) {
+        std::cerr << "Replay: SNR index " << ref.snr_index << " out of range ("
+                  << job.snrs.size() << " points)\n";
+        return;
+    }
+    BlockTally tally;
+    if (job.params.backend == ComputeBackend::Cuda) {
+        tally = {gpu::replayBlock(job, ref.snr_index, ref.block),
+                 job.params.bits_per_thread};
+    } else {
+        WorkerState worker;
+        worker.scratch.resize(1);
+        tally = run_block(job, 0, ref.snr_index, ref.block, worker);
+    }
+    const double errors = job.importance()
+                              ? tally.weighted
+                              : static_cast<double>(tally.errors);
+    std::cout << "Replay " << label << " SNR=" << std::fixed
+              << std::setprecision(12) << job.snrs[ref.snr_index]
+              << " dB, block " << ref.block
+              << ": BER=" << errors / static_cast<double>(tally.bits)
+              << ", Errors=" << tally.errors << ", Bits=" << tally.bits
+              << "\n"
+              << std::defaultfloat;
+}
+
+}  // namespace
+
+/**
+ * @brief Runs all simulations for different QAM modulation schemes.
+ *
+ * Every order of params.orders (QPSK, 16-QAM and 64-QAM by default) is
+ * scheduled as one sweep on a shared pool.
+ */
+void run_all_simulations(const SimulationParams& params) {
+    if (!params.connect_to.empty()) {
+        try {
+            run_worker(params);
+        } catch (const std::exception& e) {
+            std::cerr << "Worker: " << e.what() << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+        return;
+    }
+    SimulationParams p = params;
+    std::optional<Checkpoint> saved;
+    if (p.resume) {
+        try {
+            saved = readCheckpoint(p.checkpoint_path);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+        if (saved && p.seed && *p.seed != saved->seed) {
+            std::cerr << "--seed does not match the seed of checkpoint "
+                      << p.checkpoint_path << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+        if (saved) {
+            p.seed = saved->seed;
+        } else {
+            std::cout << "No checkpoint at " << p.checkpoint_path
+                      << ", starting a new sweep\n";
+        }
+    }
+    p.seed = resolve_seed(p);
+    const char* kernel = kernel_name(p.kernel);
+    // Before the header, so a QAM_SIMD warning does not split it
+    const simd::Isa isa = simd::activeIsa();
+    std::cout << "SIMD: " << simd::isaName(isa)
+              << ", noise engine: "
+              << makeNoiseEngine(p.noise_engine, 0)->name()
+              << ", kernel: "
+              << (p.backend == ComputeBackend::Cuda ? "cuda" : kernel)
+              << ", seed: " << *p.seed << "\n";
+    if (p.importance_bias_db > 0.0) {
+        std::cout << "Importance sampling: noise drawn "
+                  << p.importance_bias_db << " dB stronger\n";
+    }
+    if (p.affinity != AffinityMode::None) {
+        std::cout << "Affinity: "
+                  << AffinityPlan(p.affinity, CpuTopology::host()).describe()
+                  << "\n";
+    }
+
+    if (p.replay) {
+        if (const Order* found = find_order(p.replay->levels)) {
+            const Order& order = *found;
+            SimulationParams pm = p;
+            pm.bits_per_thread = padded_bits(p, order);
+            // Every kernel gives a block the same counts; replay it fused
+            if (pm.kernel == BlockKernel::Pipelined) {
+                pm.kernel = BlockKernel::Fused;
+            }
+            ModulationJob job(order.levels, order.name, pm);
+            try {
+                replay_block(job, order.label, *p.replay);
+            } catch (const std::runtime_error& e) {
+                std::cerr << e.what() << "\n";
+                std::exit(EXIT_FAILURE);
+            }
+            return;
+        }
+        std::cerr << "Replay: no modulation with M=" << p.replay->levels
+                  << "\n";
+        return;
+    }
+
+    auto jobs = make_jobs(p, true);
+
+    std::optional<Checkpointer> checkpointer;
+    if (!p.checkpoint_path.empty()) {
+        checkpointer.emplace(jobs, p);
+        if (saved) {
+            try {
+                checkpointer->restore(*saved);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                std::exit(EXIT_FAILURE);
+            }
+            std::cout << "Resumed from " << p.checkpoint_path << "\n";
+        }
+    }
+
+    std::unique_ptr<ProgressReporter> progress;
+    try {
+        progress = make_progress_reporter(p, jobs, true);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        std::exit(EXIT_FAILURE);
+    }
 
-    // QPSK
-    {
-        SimulationParams p2 = p;
-        p2.bits_per_thread = adjust_bits(2);
-        if (p2.bits_per_thread != p.bits_per_thread)
-            std::cout << "Note: bits_per_thread padded from "
-                      << p.bits_per_thread << " to " << p2.bits_per_thread
-                      << " for QPSK\n";
-        simulate_mod(4, "qpsk", p2);
-    }
-    // 16-QAM
-    {
-        SimulationParams p4 = p;
-        p4.bits_per_thread = adjust_bits(4);
-        if (p4.bits_per_thread != p.bits_per_thread)
-            std::cout << "Note: bits_per_thread padded from "
-                      << p.bits_per_thread << " to " << p4.bits_per_thread
-                      << " for 16-QAM\n";
-        simulate_mod(16, "qam16", p4);
-    }
-    // 64-QAM
-    {
-        SimulationParams p6 = p;
-        p6.bits_per_thread = adjust_bits(6);
-        if (p6.bits_per_thread != p.bits_per_thread)
-            std::cout << "Note: bits_per_thread padded from "
-                      << p.bits_per_thread << " to " << p6.bits_per_thread
-                      << " for 64-QAM\n";
-        simulate_mod(64, "qam64", p6);
-    }
-}
\ No newline at end of file
+    instr::reset();
+    const auto start = std::chrono::steady_clock::now();
+    if (p.serve_port) {
+        try {
+            run_coordinator(jobs, p,
+                            checkpointer ? &*checkpointer : nullptr,
+                            *p.serve_port);
+        } catch (const std::exception& e) {
+            std::cerr << "Coordinator: " << e.what() << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    } else {
+        try {
+            run_jobs(jobs, p.num_threads,
+                     checkpointer ? &*checkpointer : nullptr);
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << "\n";
+            std::exit(EXIT_FAILURE);
+        }
+    }
+    progress.reset();  // Last snapshot before the results
+    if (checkpointer) checkpointer->write();
+    const double wall_s = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+    auto sink = make_results_sink(p);
+    for (const auto& job : jobs) report(*job, *sink);
+    if (!sink->finish(run_metadata(p, wall_s))) {
+        std::cerr << "Could not write the results\n";
+    }
+
+    if constexpr (instr::enabled()) {
+        instr::writeReport(std::cout, wall_s);
+        if (!instr::writeJson(p.instrumentation_json, wall_s)) {
+            std::cerr << "Could not write " << p.instrumentation_json << "\n";
+        }
+    }
+}
@@ -0,0 +1,203 @@
+#include "qam_simulator/stage_pipeline.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+#include "qam_simulator/noise.hpp"
+#include "qam_simulator/pipeline.hpp"
+#include "qam_simulator/rng.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// @brief Pop from @p ring, spinning while empty; adds the wait to @p waited
+template <typename T>
+void pop_wait(SpscRing<T>& ring, T& out, double& waited) {
+    if (ring.tryPop(out)) return;
+    const auto start = Clock::now();
+    while (!ring.tryPop(out)) std::this_thread::yield();
+    waited += seconds_since(start);
+}
+
+/// @brief Push to @p ring, spinning while full; adds the wait to @p waited
+template <typename T>
+void push_wait(SpscRing<T>& ring, T value, double& waited) {
+    if (ring.tryPush(value)) return;
+    const auto start = Clock::now();
+    while (!ring.tryPush(value)) std::this_thread::yield();
+    waited += seconds_since(start);
+}
+
+/**
+ * @brief Body of a middle stage: take a frame, process it, pass it on.
+ *
+ * A null frame marks the end of the stream; it is forwarded and ends the
+ * stage.
+ */
+template <typename FramePtr, typename Work>
+void relay(SpscRing<FramePtr>& in, SpscRing<FramePtr>& out, StageStats& stats,
+           Work work) {
+    for (;;) {
+        FramePtr frame = nullptr;
+        pop_wait(in, frame, stats.starved_s);
+        if (frame) {
+            const auto start = Clock::now();
+            work(*frame);
+            stats.busy_s += seconds_since(start);
+            ++stats.frames;
+            stats.bits += frame->bits.size();
+        }
+        push_wait(out, frame, stats.blocked_s);
+        if (!frame) return;
+    }
+}
+
+}  // namespace
+
+StageStats& StageStats::operator+=(const StageStats& other) {
+    frames += other.frames;
+    bits += other.bits;
+    busy_s += other.busy_s;
+    starved_s += other.starved_s;
+    blocked_s += other.blocked_s;
+    return *this;
+}
+
+StagePipeline::StagePipeline(const ModulatorQAM& mod,
+                             const DemodulatorQAM& demod,
+                             NoiseEngineKind noise, size_t frame_bits,
+                             size_t depth)
+    : mod_(mod),
+      demod_(demod),
+      noise_kind_(noise),
+      frame_bits_(frame_bits),
+      // Every stage holds at most one frame besides the full rings
+      frames_(3 * depth + 4),
+      free_(frames_.size()),
+      generated_(depth),
+      modulated_(depth),
+      received_(depth) {
+    if (frame_bits_ == 0 || frame_bits_ % mod_.getBitsPerSymbol() != 0) {
+        throw std::invalid_argument(
+            "StagePipeline: frame size must be a positive multiple of "
+            "BitsPerSymbol");
+    }
+    if (demod_.getLevelsCount() != mod_.getLevelsCount()) {
+        throw std::invalid_argument(
+            "StagePipeline: modulator and demodulator orders differ");
+    }
+    for (Frame& frame : frames_) {
+        frame.bits.resize(frame_bits_);
+        frame.samples.resize(frame_bits_ / mod_.getBitsPerSymbol());
+        frame.decided.resize(frame_bits_);
+        Frame* ptr = &frame;
+        free_.tryPush(ptr);
+    }
+}
+
+StagePipelineResult StagePipeline::run(double snr_db, size_t block_bits,
+                                       uint64_t max_blocks,
+                                       const StoppingRule& stopping,
+                                       const StreamKey& key) {
+    if (block_bits == 0 || block_bits % mod_.getBitsPerSymbol() != 0) {
+        throw std::invalid_argument(
+            "StagePipeline: block size must be a positive multiple of "
+            "BitsPerSymbol");
+    }
+
+    StagePipelineResult result;
+    auto& st = result.stages;
+    st[StagePipelineResult::Generate].name = "generate";
+    st[StagePipelineResult::Modulate].name = "modulate";
+    st[StagePipelineResult::Channel].name = "channel";
+    st[StagePipelineResult::Demodulate].name = "demodulate";
+    stop_.store(false);
+
+    Xoshiro256 rng;
+    NoiseAdder noise(snr_db, mod_.getAveragePower(), noise_kind_, 0);
+    const auto start = Clock::now();
+
+    std::thread modulate([&] {
+        relay(generated_, modulated_, st[StagePipelineResult::Modulate],
+              [&](Frame& f) { mod_.modulate(f.bits, f.samples); });
+    });
+    std::thread channel([&] {
+        relay(modulated_, received_, st[StagePipelineResult::Channel],
+              [&](Frame& f) {
+                  if (f.block_start) {
+                      noise.getEngine().seed(blockSeeds(key, f.block).noise);
+                  }
+                  noise.addNoise(f.samples.view());
+              });
+    });
+    std::thread demodulate([&] {
+        StageStats& stats = st[StagePipelineResult::Demodulate];
+        uint64_t block_errors = 0;
+        uint64_t block_bits_seen = 0;
+        bool closed = false;  // Stopping rule met; later frames are dropped
+        for (;;) {
+            Frame* frame = nullptr;
+            pop_wait(received_, frame, stats.starved_s);
+            if (!frame) return;
+            if (!closed) {
+                const auto t0 = Clock::now();
+                demod_.demodulate_hard(frame->samples, frame->decided);
+                block_errors += count_bit_errors(frame->bits, frame->decided);
+                block_bits_seen += frame->bits.size();
+                stats.busy_s += seconds_since(t0);
+                ++stats.frames;
+                stats.bits += frame->bits.size();
+                if (frame->block_end) {
+                    result.errors += block_errors;
+                    result.bits += block_bits_seen;
+                    block_errors = 0;
+                    block_bits_seen = 0;
+                    if (stopping.adaptive() &&
+                        stopping.converged(result.errors, result.bits)) {
+                        closed = true;
+                        stop_.store(true, std::memory_order_relaxed);
+                    }
+                }
+            }
+            push_wait(free_, frame, stats.blocked_s);
+        }
+    });
+
+    // The calling thread is the bit source
+    StageStats& gen = st[StagePipelineResult::Generate];
+    for (uint64_t block = 0;
+         block < max_blocks && !stop_.load(std::memory_order_relaxed);
+         ++block) {
+        rng.seed(blockSeeds(key, block).bits);
+        for (size_t done = 0; done < block_bits;) {
+            Frame* frame = nullptr;
+            pop_wait(free_, frame, gen.starved_s);
+            const auto t0 = Clock::now();
+            const size_t n = std::min(frame_bits_, block_bits - done);
+            if (frame->bits.size() != n) frame->bits.resize(n);
+            generateRandomBits(frame->bits, rng);
+            frame->block = block;
+            frame->block_start = done == 0;
+            frame->block_end = done + n == block_bits;
+            gen.busy_s += seconds_since(t0);
+            ++gen.frames;
+            gen.bits += n;
+            done += n;
+            push_wait(generated_, frame, gen.blocked_s);
+        }
+    }
+    push_wait(generated_, static_cast<Frame*>(nullptr), gen.blocked_s);
+
+    modulate.join();
+    channel.join();
+    demodulate.join();
+    result.wall_s = seconds_since(start);
+    return result;
+}
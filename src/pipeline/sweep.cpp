@@ -0,0 +1,347 @@
+#include "qam_simulator/sweep.hpp"
+
+#include <bit>
+#include <cmath>
+#include <numeric>
+
+#include "qam_simulator/alloc_counter.hpp"
+#include "qam_simulator/instrumentation.hpp"
+#include "qam_simulator/thread_pool.hpp"
+
+namespace {
+
+/**
+ * @brief Adds the likelihood-ratio weighted errors of @p decided to
+ * @p tally.
+ *
+ * Symbol k carries bits (first + k) * bps of @p sent, was transmitted as
+ * clean[k] and received as received[k]. Only errored symbols are weighed.
+ */
+void weigh_errors(ConstPackedBitsView sent, size_t first,
+                  ConstPackedBitsView decided, ConstSampleView clean,
+                  ConstSampleView received, const NoiseAdder& noise, int bps,
+                  BlockTally& tally) {
+    for (size_t k = 0; k < received.size(); ++k) {
+        const uint64_t diff = sent.read((first + k) * bps, bps) ^
+                              decided.read(k * bps, bps);
+        if (diff == 0) continue;
+        const double n_re = received.re[k] - clean.re[k];
+        const double n_im = received.im[k] - clean.im[k];
+        const double ew = std::popcount(diff) *
+                          noise.likelihoodRatio(n_re * n_re + n_im * n_im);
+        tally.weighted += ew;
+        tally.weighted_sq += ew * ew;
+    }
+}
+
+/**
+ * @brief Staged kernel: one pass over the whole chunk per stage.
+ */
+void run_staged(const ModulationJob& job, ConstPackedBitsView bits,
+                JobScratch& sc, BlockTally& tally) {
+    const int bps = job.mod.getBitsPerSymbol();
+    SampleView s = sc.s.subview(0, bits.size() / bps);
+    const PackedBitsView r(sc.r.data(), bits.size());
+    QAM_INSTR_TIME(Modulate, sc.mod.modulate(bits, s));
+    if (sc.weigh) {
+        std::copy_n(s.re, s.size(), sc.x.re);
+        std::copy_n(s.im, s.size(), sc.x.im);
+    }
+    QAM_INSTR_TIME(Noise, sc.noise.addNoise(s));
+    QAM_INSTR_TIME(Demodulate, sc.demod.demodulate_hard(s, r));
+    QAM_INSTR_TIME(Count, tally.errors += count_bit_errors(bits, r));
+    if (sc.weigh) {
+        weigh_errors(bits, 0, r, sc.x.subview(0, s.size()), s, sc.noise,
+                     bps, tally);
+    }
+}
+
+/**
+ * @brief Fused kernel: modulate, add noise, slice and count one tile at a
+ * time, so samples and decisions never leave L1.
+ *
+ * Tiles are a multiple of the noise engines' tile, so both kernels draw the
+ * same noise and count the same errors.
+ */
+void run_fused(const ModulationJob& job, ConstPackedBitsView bits,
+               JobScratch& sc, BlockTally& tally) {
+    const int bps = job.mod.getBitsPerSymbol();
+    const size_t num_symbols = bits.size() / bps;
+    const auto words = bits.words();
+
+    for (size_t i = 0; i < num_symbols; i += kFusedTile) {
+        const size_t n = std::min(kFusedTile, num_symbols - i);
+        SampleView tile = sc.s.subview(0, n);
+        const PackedBitsView r(sc.r.data(), n * bps);
+        QAM_INSTR_TIME(Modulate, sc.mod.modulate(bits, i, tile));
+        if (sc.weigh) {
+            std::copy_n(tile.re, n, sc.x.re);
+            std::copy_n(tile.im, n, sc.x.im);
+        }
+        QAM_INSTR_TIME(Noise, sc.noise.addNoise(tile));
+        QAM_INSTR_TIME(Demodulate, sc.demod.demodulate_hard(tile, r));
+        QAM_INSTR_TIME(
+            Count, tally.errors += count_bit_errors(
+                       r.words(),
+                       words.subspan(i * bps / PackedBits::kWordBits)));
+        if (sc.weigh) {
+            weigh_errors(bits, i, r, sc.x.subview(0, n), tile, sc.noise, bps,
+                         tally);
+        }
+    }
+}
+
+/// @brief Seconds between snapshots when only a status file or the
+/// metrics endpoint is asked for
+constexpr double kStatusInterval_s = 10.0;
+
+/**
+ * @brief Live counts of @p jobs for the ProgressReporter, from relaxed
+ * loads only, so the workers never wait for a snapshot.
+ *
+ * @param points False to report throughput alone, as a distributed worker
+ * does: its points finish on the coordinator
+ */
+void collect_progress(const std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                      bool points, ProgressSnapshot& out) {
+    out.symbols = 0;
+    out.busy_s = 0.0;
+    out.points.clear();
+    for (const auto& job : jobs) {
+        const auto bps = static_cast<uint64_t>(job->mod.getBitsPerSymbol());
+        const Order* order = find_order(job->levels);
+        for (size_t i = 0; i < job->snrs.size(); ++i) {
+            const uint64_t bits =
+                job->done_bits[i].load(std::memory_order_relaxed);
+            out.symbols += bits / bps;
+            out.busy_s += static_cast<double>(job->busy_ns[i].load(
+                              std::memory_order_relaxed)) *
+                          1e-9;
+            if (!points) continue;
+            out.points.push_back(
+                {job->name, order ? order->label : job->name, job->snrs[i],
+                 job->done_errors[i].load(std::memory_order_relaxed), bits,
+                 job->finished(i)});
+        }
+    }
+}
+
+}  // namespace
+
+const Order* find_order(int levels) {
+    for (const Order& order : kOrders) {
+        if (order.levels == levels) return &order;
+    }
+    return nullptr;
+}
+
+size_t shared_payload_unit(const SimulationParams& p) {
+    size_t unit = 1;
+    for (int levels : p.orders) {
+        unit = std::lcm(unit, static_cast<size_t>(qamBitsPerSymbol(levels)));
+    }
+    return unit;
+}
+
+size_t payload_unit(const SimulationParams& p, size_t bits_per_symbol) {
+    return p.shared_payload ? shared_payload_unit(p) : bits_per_symbol;
+}
+
+size_t chunk_bits(const ModulationJob& job) {
+    const size_t tile_bits = kFusedTile * job.payload_bits;
+    const size_t requested = job.params.block_bits > 0
+                                 ? job.params.block_bits
+                                 : job.params.bits_per_thread;
+    const size_t rounded =
+        std::max(tile_bits, requested / tile_bits * tile_bits);
+    return std::min(rounded, job.params.bits_per_thread);
+}
+
+WorkerState& workerState(
+    std::vector<std::unique_ptr<WorkerState>>& workers,
+    const std::vector<std::unique_ptr<ModulationJob>>& jobs) {
+    auto& slot = workers[ThreadPool::currentWorker()];
+    if (!slot) slot = std::make_unique<WorkerState>(jobs);
+    return *slot;
+}
+
+BlockTally run_block(ModulationJob& job, size_t job_index, size_t snr_index,
+                     uint64_t block, WorkerState& worker) {
+    auto& slot = worker.scratch[job_index];
+    if (!slot) slot = std::make_unique<JobScratch>(job);
+    JobScratch& sc = *slot;
+    worker.arena.reset();
+    worker.arena.reserve(sc.arena_bytes);
+
+    const uint64_t before = thread_allocation_count();
+    const BlockSeeds seeds = blockSeeds(job.streamKey(snr_index), block);
+    worker.rng.seed(seeds.bits);
+    sc.noise.getEngine().seed(seeds.noise);
+    sc.noise.setSNRdb(job.snrs[snr_index]);
+    uint64_t* words =
+        worker.arena.allocate<uint64_t>(PackedBits::wordsFor(sc.chunk))
+            .data();
+    sc.carve(worker.arena);
+    BlockTally tally;
+    for (size_t done = 0; done < job.params.bits_per_thread;) {
+        const size_t n = std::min(sc.chunk, job.params.bits_per_thread - done);
+        const PackedBitsView bits(words, n);
+        QAM_INSTR_TIME(Bits, generateRandomBits(bits, worker.rng));
+        QAM_INSTR_SYMBOLS(n / job.mod.getBitsPerSymbol());
+        if (job.params.kernel == BlockKernel::Fused) {
+            run_fused(job, bits, sc, tally);
+        } else {
+            run_staged(job, bits, sc, tally);
+        }
+        tally.bits += n;
+        done += n;
+    }
+    sc.allocations += thread_allocation_count() - before;
+    return tally;
+}
+
+void run_shared_block(std::vector<std::unique_ptr<ModulationJob>>& jobs,
+                      size_t snr_index, uint64_t block, WorkerState& worker) {
+    using Clock = std::chrono::steady_clock;
+    auto ns_since = [](Clock::time_point t) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - t)
+                .count());
+    };
+    size_t arena_bytes = 0;
+    for (size_t j : worker.open) {
+        auto& slot = worker.scratch[j];
+        if (!slot) slot = std::make_unique<JobScratch>(*jobs[j]);
+        arena_bytes += slot->arena_bytes;
+    }
+    const size_t chunk = worker.scratch[worker.open.front()]->chunk;
+    const size_t payload_words = PackedBits::wordsFor(chunk);
+    worker.arena.reset();
+    worker.arena.reserve(arena_bytes +
+                         Arena::bytesFor<uint64_t>(payload_words));
+
+    const ModulationJob& first = *jobs[worker.open.front()];
+    const uint64_t before = thread_allocation_count();
+    worker.rng.seed(blockSeeds(first.streamKey(snr_index), block).bits);
+    worker.payload = worker.arena.allocate<uint64_t>(payload_words);
+    for (size_t j : worker.open) {
+        JobScratch& sc = *worker.scratch[j];
+        sc.noise.getEngine().seed(
+            blockSeeds(jobs[j]->streamKey(snr_index), block).noise);
+        sc.noise.setSNRdb(jobs[j]->snrs[snr_index]);
+        sc.carve(worker.arena);
+        worker.tallies[j] = BlockTally{};
+        worker.job_ns[j] = 0;
+    }
+    const size_t block_bits = first.params.bits_per_thread;
+    uint64_t generate_ns = 0;
+    for (size_t done = 0; done < block_bits;) {
+        const size_t n = std::min(chunk, block_bits - done);
+        const PackedBitsView payload(worker.payload.data(), n);
+        auto t = Clock::now();
+        QAM_INSTR_TIME(Bits, generateRandomBits(payload, worker.rng));
+        generate_ns += ns_since(t);
+        for (size_t j : worker.open) {
+            const ModulationJob& job = *jobs[j];
+            JobScratch& sc = *worker.scratch[j];
+            t = Clock::now();
+            QAM_INSTR_SYMBOLS(n / job.mod.getBitsPerSymbol());
+            if (job.params.kernel == BlockKernel::Fused) {
+                run_fused(job, payload, sc, worker.tallies[j]);
+            } else {
+                run_staged(job, payload, sc, worker.tallies[j]);
+            }
+            worker.tallies[j].bits += n;
+            worker.job_ns[j] += ns_since(t);
+        }
+        done += n;
+    }
+    for (size_t j : worker.open) {
+        worker.job_ns[j] += generate_ns / worker.open.size();
+    }
+    worker.scratch[worker.open.front()]->allocations +=
+        thread_allocation_count() - before;
+}
+
+uint64_t config_fingerprint(
+    const std::vector<std::unique_ptr<ModulationJob>>& jobs) {
+    constexpr uint64_t kLabellingRevision = 1;
+    uint64_t state = 0;
+    auto fold = [&](uint64_t value) { state = splitmix64(state) ^ value; };
+    for (const auto& job : jobs) {
+        fold(static_cast<uint64_t>(job->levels));
+        fold(job->params.bits_per_thread);
+        fold(static_cast<uint64_t>(job->params.noise_engine));
+        fold(job->snrs.size());
+        for (double snr : job->snrs) fold(std::bit_cast<uint64_t>(snr));
+        // Only folded when set, so independent-payload checkpoints of
+        // earlier versions stay valid
+        if (job->params.shared_payload) {
+            fold(shared_payload_unit(job->params));
+        }
+        if (job->importance()) {
+            fold(std::bit_cast<uint64_t>(job->params.importance_bias_db));
+        }
+        // The device draws other streams than the CPU kernels
+        if (job->params.backend != ComputeBackend::Cpu) {
+            fold(static_cast<uint64_t>(job->params.backend));
+        }
+    }
+    // Revision of the bit labelling; QPSK and 64-QAM counts changed when
+    // every order moved to the generic Gray mapping
+    fold(kLabellingRevision);
+    return splitmix64(state);
+}
+
+size_t padded_bits(const SimulationParams& p, const Order& order) {
+    const size_t unit = payload_unit(p, order.bits_per_symbol);
+    const size_t rem = p.bits_per_thread % unit;
+    return rem == 0 ? p.bits_per_thread : p.bits_per_thread + (unit - rem);
+}
+
+std::vector<std::unique_ptr<ModulationJob>> make_jobs(
+    const SimulationParams& p, bool announce) {
+    std::vector<std::unique_ptr<ModulationJob>> jobs;
+    for (int levels : p.orders) {
+        const Order& order = *find_order(levels);
+        SimulationParams pm = p;
+        pm.bits_per_thread = padded_bits(p, order);
+        // A shared payload pads every order alike; say so once
+        const bool first = jobs.empty();
+        if (announce && pm.bits_per_thread != p.bits_per_thread &&
+            (first || !p.shared_payload))
+            std::cout << "Note: bits_per_thread padded from "
+                      << p.bits_per_thread << " to " << pm.bits_per_thread
+                      << " for "
+                      << (p.shared_payload ? "the shared payload"
+                                           : order.label)
+                      << "\n";
+        jobs.push_back(
+            std::make_unique<ModulationJob>(order.levels, order.name, pm));
+    }
+    return jobs;
+}
+
+std::unique_ptr<ProgressReporter> make_progress_reporter(
+    const SimulationParams& p,
+    const std::vector<std::unique_ptr<ModulationJob>>& jobs, bool points) {
+    if (p.progress_interval_s <= 0.0 && p.status_file.empty() &&
+        !p.metrics_port) {
+        return nullptr;
+    }
+    ProgressOptions options;
+    options.interval_s = p.progress_interval_s > 0.0 ? p.progress_interval_s
+                                                     : kStatusInterval_s;
+    options.lines = p.progress_interval_s > 0.0;
+    options.status_file = p.status_file;
+    options.port = p.metrics_port;
+    auto reporter = std::make_unique<ProgressReporter>(
+        options, [&jobs, points](ProgressSnapshot& out) {
+            collect_progress(jobs, points, out);
+        });
+    if (p.metrics_port) {
+        std::cout << "Metrics on port " << reporter->port() << std::endl;
+    }
+    return reporter;
+}
@@ -0,0 +1,112 @@
+#include "qam_simulator/thread_pool.hpp"
+
+#include <algorithm>
+
+#include "qam_simulator/instrumentation.hpp"
+
+namespace {
+
+thread_local int current_worker = -1;
+
+}  // namespace
+
+ThreadPool::ThreadPool(int num_threads, StartHook on_start) {
+    const int n = std::max(1, num_threads);
+    queues_.reserve(n);
+    for (int i = 0; i < n; ++i) queues_.push_back(std::make_unique<Queue>());
+    threads_.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        threads_.emplace_back([this, i, on_start] { workerLoop(i, on_start); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock<std::mutex> lock(state_mutex_);
+        idle_cv_.wait(lock, [this] { return pending_.load() == 0; });
+        stop_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto& th : threads_) th.join();
+}
+
+int ThreadPool::currentWorker() noexcept { return current_worker; }
+
+void ThreadPool::submit(Task task) {
+    const int self = current_worker;
+    const size_t index =
+        self >= 0 ? static_cast<size_t>(self)
+                  : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                        queues_.size();
+    pending_.fetch_add(1);
+    // Counted before the push so a racing pop can never drive it below 0
+    queued_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    // Taking the lock orders this wake-up after a sleeper's predicate check
+    { std::lock_guard<std::mutex> lock(state_mutex_); }
+    wake_cv_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(state_mutex_);
+    idle_cv_.wait(lock, [this] { return pending_.load() == 0; });
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::tryPop(int index, Task& task) {
+    {
+        Queue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    const size_t n = queues_.size();
+    for (size_t k = 1; k < n; ++k) {
+        Queue& victim = *queues_[(index + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(int index, const StartHook& on_start) {
+    current_worker = index;
+    if (on_start) on_start(index);
+    QAM_INSTR_REGISTER_THREAD();
+    Task task;
+    for (;;) {
+        if (tryPop(index, task)) {
+            queued_.fetch_sub(1);
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+            task = nullptr;
+            if (pending_.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                idle_cv_.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(state_mutex_);
+        QAM_INSTR_IDLE_SCOPE();
+        wake_cv_.wait(lock, [this] { return stop_ || queued_.load() > 0; });
+        if (stop_ && queued_.load() == 0) return;
+    }
+}
@@ -0,0 +1,87 @@
+#include "qam_simulator/alloc_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local uint64_t allocations = 0;
+
+void* allocate(std::size_t size) {
+    ++allocations;
+    if (size == 0) size = 1;
+    return std::malloc(size);
+}
+
+void* allocate_aligned(std::size_t size, std::align_val_t al) {
+    ++allocations;
+    const std::size_t alignment = static_cast<std::size_t>(al);
+    // aligned_alloc requires the size to be a multiple of the alignment
+    size = (size + alignment - 1) / alignment * alignment;
+    if (size == 0) size = alignment;
+    return std::aligned_alloc(alignment, size);
+}
+
+void* allocate_or_throw(std::size_t size) {
+    void* p = allocate(size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void* allocate_aligned_or_throw(std::size_t size, std::align_val_t al) {
+    void* p = allocate_aligned(size, al);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+}  // namespace
+
+uint64_t thread_allocation_count() noexcept { return allocations; }
+
+void* operator new(std::size_t size) { return allocate_or_throw(size); }
+void* operator new[](std::size_t size) { return allocate_or_throw(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+void* operator new(std::size_t size, std::align_val_t al) {
+    return allocate_aligned_or_throw(size, al);
+}
+void* operator new[](std::size_t size, std::align_val_t al) {
+    return allocate_aligned_or_throw(size, al);
+}
+void* operator new(std::size_t size, std::align_val_t al,
+                   const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, al);
+}
+void* operator new[](std::size_t size, std::align_val_t al,
+                     const std::nothrow_t&) noexcept {
+    return allocate_aligned(size, al);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, std::align_val_t,
+                     const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+void operator delete[](void* p, std::align_val_t,
+                       const std::nothrow_t&) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,101 @@
+#include "qam_simulator/checkpoint.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+constexpr char kMagic[8] = {'Q', 'A', 'M', 'C', 'K', 'P', 'T', '\0'};
+/// @brief Version 2 added the importance-sampling sums of each point
+constexpr uint32_t kVersion = 2;
+
+/// @brief Upper bound on counts read back, against corrupt headers
+constexpr uint32_t kMaxEntries = 1u << 20;
+
+template <typename T>
+void put(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+T get(std::istream& in) {
+    T value{};
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+        throw std::runtime_error("checkpoint: truncated file");
+    }
+    return value;
+}
+
+}  // namespace
+
+bool writeCheckpoint(const std::string& path, const Checkpoint& checkpoint) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(kMagic, sizeof(kMagic));
+        put(out, kVersion);
+        put(out, checkpoint.seed);
+        put(out, checkpoint.config);
+        put(out, static_cast<uint32_t>(checkpoint.modulations.size()));
+        for (const ModulationCheckpoint& mod : checkpoint.modulations) {
+            put(out, static_cast<int32_t>(mod.levels));
+            put(out, static_cast<uint32_t>(mod.points.size()));
+            for (const PointCheckpoint& point : mod.points) {
+                put(out, point.blocks);
+                put(out, point.errors);
+                put(out, point.bits);
+                put(out, point.weighted);
+                put(out, point.weighted_sq);
+            }
+        }
+        out.flush();
+        if (!out) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+std::optional<Checkpoint> readCheckpoint(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return std::nullopt;
+
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) ||
+        !std::equal(magic, magic + sizeof(magic), kMagic)) {
+        throw std::runtime_error("checkpoint: " + path +
+                                 " is not a checkpoint file");
+    }
+    const auto version = get<uint32_t>(in);
+    if (version == 0 || version > kVersion) {
+        throw std::runtime_error("checkpoint: unsupported version in " + path);
+    }
+
+    Checkpoint checkpoint;
+    checkpoint.seed = get<uint64_t>(in);
+    checkpoint.config = get<uint64_t>(in);
+    const auto modulations = get<uint32_t>(in);
+    if (modulations > kMaxEntries) {
+        throw std::runtime_error("checkpoint: corrupt header in " + path);
+    }
+    checkpoint.modulations.resize(modulations);
+    for (ModulationCheckpoint& mod : checkpoint.modulations) {
+        mod.levels = get<int32_t>(in);
+        const auto points = get<uint32_t>(in);
+        if (points > kMaxEntries) {
+            throw std::runtime_error("checkpoint: corrupt header in " + path);
+        }
+        mod.points.resize(points);
+        for (PointCheckpoint& point : mod.points) {
+            point.blocks = get<uint64_t>(in);
+            point.errors = get<uint64_t>(in);
+            point.bits = get<uint64_t>(in);
+            if (version >= 2) {
+                point.weighted = get<double>(in);
+                point.weighted_sq = get<double>(in);
+            }
+        }
+    }
+    return checkpoint;
+}
@@ -0,0 +1,157 @@
+#include "qam_simulator/instrumentation.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace instr {
+
+namespace {
+
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadCounters>> registry;
+
+thread_local ThreadCounters* this_thread_counters = nullptr;
+
+double seconds(uint64_t ns) { return static_cast<double>(ns) * 1e-9; }
+
+uint64_t busy_ns(const ThreadCounters& c) {
+    uint64_t total = 0;
+    for (uint64_t ns : c.stage_ns) total += ns;
+    return total;
+}
+
+uint64_t allocations(const ThreadCounters& c) {
+    uint64_t total = 0;
+    for (uint64_t n : c.stage_allocations) total += n;
+    return total;
+}
+
+bool active(const ThreadCounters& c) {
+    return busy_ns(c) > 0 || c.idle_ns > 0 || c.symbols > 0;
+}
+
+/// @brief Per-stage totals over every registered thread
+ThreadCounters totals() {
+    ThreadCounters sum;
+    for (const auto& c : registry) {
+        for (size_t s = 0; s < kStageCount; ++s) {
+            sum.stage_ns[s] += c->stage_ns[s];
+            sum.stage_calls[s] += c->stage_calls[s];
+            sum.stage_allocations[s] += c->stage_allocations[s];
+        }
+        sum.symbols += c->symbols;
+        sum.idle_ns += c->idle_ns;
+    }
+    return sum;
+}
+
+double symbols_per_s(const ThreadCounters& c) {
+    const uint64_t ns = busy_ns(c);
+    return ns > 0 ? static_cast<double>(c.symbols) / seconds(ns) : 0.0;
+}
+
+}  // namespace
+
+const char* stageName(Stage stage) noexcept {
+    switch (stage) {
+        case Stage::Bits:
+            return "bits";
+        case Stage::Modulate:
+            return "modulate";
+        case Stage::Noise:
+            return "noise";
+        case Stage::Demodulate:
+            return "demodulate";
+        case Stage::Count:
+            return "count";
+    }
+    return "?";
+}
+
+ThreadCounters& threadCounters() {
+    if (!this_thread_counters) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        registry.push_back(std::make_unique<ThreadCounters>());
+        this_thread_counters = registry.back().get();
+    }
+    return *this_thread_counters;
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto& c : registry) *c = ThreadCounters{};
+}
+
+void writeReport(std::ostream& os, double wall_s) {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    const ThreadCounters sum = totals();
+    const double busy = seconds(busy_ns(sum));
+
+    os << "=== Instrumentation (wall " << std::fixed << std::setprecision(3)
+       << wall_s << " s) ===\n";
+    os << "Stage           Calls    Time[s]  Share%    Allocs\n";
+    for (size_t s = 0; s < kStageCount; ++s) {
+        const double t = seconds(sum.stage_ns[s]);
+        os << std::left << std::setw(12) << stageName(static_cast<Stage>(s))
+           << std::right << std::setw(9) << sum.stage_calls[s]
+           << std::setw(11) << std::setprecision(3) << t << std::setw(8)
+           << std::setprecision(1) << (busy > 0 ? 100.0 * t / busy : 0.0)
+           << std::setw(10) << sum.stage_allocations[s] << "\n";
+    }
+
+    os << "Thread        Symbols    Busy[s]    Idle[s]    Msym/s    Allocs\n";
+    size_t index = 0;
+    for (const auto& c : registry) {
+        if (!active(*c)) continue;
+        os << std::left << std::setw(8) << index++ << std::right
+           << std::setw(13) << c->symbols << std::setw(11)
+           << std::setprecision(3) << seconds(busy_ns(*c)) << std::setw(11)
+           << seconds(c->idle_ns) << std::setw(10) << std::setprecision(1)
+           << symbols_per_s(*c) / 1e6 << std::setw(10) << allocations(*c)
+           << "\n";
+    }
+    os << std::defaultfloat;
+}
+
+bool writeJson(const std::string& path, double wall_s) {
+    std::ofstream out(path);
+    if (!out) return false;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    const ThreadCounters sum = totals();
+
+    out << std::setprecision(9) << "{\n  \"wall_s\": " << wall_s
+        << ",\n  \"stages\": [";
+    for (size_t s = 0; s < kStageCount; ++s) {
+        out << (s ? ",\n" : "\n") << "    {\"name\": \""
+            << stageName(static_cast<Stage>(s))
+            << "\", \"calls\": " << sum.stage_calls[s]
+            << ", \"seconds\": " << seconds(sum.stage_ns[s])
+            << ", \"allocations\": " << sum.stage_allocations[s] << "}";
+    }
+    out << "\n  ],\n  \"threads\": [";
+    size_t index = 0;
+    for (const auto& c : registry) {
+        if (!active(*c)) continue;
+        out << (index ? ",\n" : "\n") << "    {\"index\": " << index
+            << ", \"symbols\": " << c->symbols
+            << ", \"busy_s\": " << seconds(busy_ns(*c))
+            << ", \"idle_s\": " << seconds(c->idle_ns)
+            << ", \"symbols_per_s\": " << symbols_per_s(*c)
+            << ", \"allocations\": " << allocations(*c)
+            << ", \"stage_seconds\": {";
+        for (size_t s = 0; s < kStageCount; ++s) {
+            out << (s ? ", " : "") << "\""
+                << stageName(static_cast<Stage>(s))
+                << "\": " << seconds(c->stage_ns[s]);
+        }
+        out << "}}";
+        ++index;
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+}  // namespace instr
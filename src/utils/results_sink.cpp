@@ -0,0 +1,174 @@
+#include "qam_simulator/results_sink.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+std::string join_path(const std::string& directory, const std::string& file) {
+    if (directory.empty()) return file;
+    return directory.back() == '/' ? directory + file : directory + "/" + file;
+}
+
+/**
+ * @brief @p value with 12 significant digits.
+ *
+ * The CSV rows are otherwise fixed-point with 12 decimals, which would
+ * keep only a few digits of an importance-sampled BER of 1e-10, and none
+ * of its variance.
+ */
+std::string scientific(double value) {
+    std::ostringstream os;
+    os << std::scientific << std::setprecision(11) << value;
+    return os.str();
+}
+
+template <typename T>
+void put(std::ostream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put_string(std::ostream& out, const std::string& s) {
+    put(out, static_cast<uint32_t>(s.size()));
+    out.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+/// @brief Zero bytes up to the next multiple of @p alignment
+void pad_to(std::ostream& out, uint64_t& offset, uint64_t alignment) {
+    static constexpr char kZeros[64] = {};
+    const uint64_t padded = (offset + alignment - 1) / alignment * alignment;
+    out.write(kZeros, static_cast<std::streamsize>(padded - offset));
+    offset = padded;
+}
+
+/// @brief Fixed-size, NUL-padded field of the column directory
+template <size_t N>
+void put_fixed(std::ostream& out, const char* s) {
+    char field[N] = {};
+    std::memcpy(field, s, std::min(N, std::strlen(s)));
+    out.write(field, N);
+}
+
+constexpr char kMagic[8] = {'Q', 'A', 'M', 'R', 'E', 'S', '0', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kColumnAlignment = 64;
+
+struct Column {
+    const char* name;
+    const char* dtype;
+    const void* data;
+    size_t bytes;
+};
+
+}  // namespace
+
+CsvResultsSink::CsvResultsSink(std::string directory)
+    : directory_(std::move(directory)) {}
+
+void CsvResultsSink::add(const ResultRow& row) {
+    auto& writer = writers_[row.modulation];
+    if (!writer) {
+        writer = std::make_unique<CsvWriter>(
+            join_path(directory_, "ber_" + row.modulation + ".csv"));
+        writer->write_header(
+            "SNR_dB,BER,Errors,Bits,RelCI95,Seconds,BERVariance");
+    }
+    writer->write_values(row.snr_db, scientific(row.ber), row.errors,
+                         row.bits, row.rel_ci95, row.seconds,
+                         scientific(row.ber_variance));
+}
+
+bool CsvResultsSink::finish(const RunMetadata& metadata) {
+    writers_.clear();
+    std::ofstream out(join_path(directory_, "run_metadata.csv"));
+    out << "key,value\n";
+    for (const auto& [key, value] : metadata) {
+        out << key << "," << value << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+BinaryResultsSink::BinaryResultsSink(std::string path)
+    : path_(std::move(path)) {}
+
+void BinaryResultsSink::add(const ResultRow& row) {
+    levels_.push_back(row.levels);
+    snr_db_.push_back(row.snr_db);
+    errors_.push_back(row.errors);
+    bits_.push_back(row.bits);
+    ber_.push_back(row.ber);
+    rel_ci95_.push_back(row.rel_ci95);
+    seconds_.push_back(row.seconds);
+    ber_var_.push_back(row.ber_variance);
+}
+
+bool BinaryResultsSink::finish(const RunMetadata& metadata) {
+    const Column columns[] = {
+        {"levels", "<i8", levels_.data(), levels_.size() * sizeof(int64_t)},
+        {"snr_db", "<f8", snr_db_.data(), snr_db_.size() * sizeof(double)},
+        {"errors", "<u8", errors_.data(), errors_.size() * sizeof(uint64_t)},
+        {"bits", "<u8", bits_.data(), bits_.size() * sizeof(uint64_t)},
+        {"ber", "<f8", ber_.data(), ber_.size() * sizeof(double)},
+        {"rel_ci95", "<f8", rel_ci95_.data(),
+         rel_ci95_.size() * sizeof(double)},
+        {"seconds", "<f8", seconds_.data(), seconds_.size() * sizeof(double)},
+        {"ber_var", "<f8", ber_var_.data(), ber_var_.size() * sizeof(double)},
+    };
+    constexpr uint32_t kColumns = sizeof(columns) / sizeof(columns[0]);
+    constexpr uint64_t kDirectoryEntry = 16 + 8 + sizeof(uint64_t);
+
+    std::ofstream out(path_, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    uint64_t offset = sizeof(kMagic) + 2 * sizeof(uint32_t);
+    out.write(kMagic, sizeof(kMagic));
+    put(out, kVersion);
+    put(out, static_cast<uint32_t>(metadata.size()));
+    for (const auto& [key, value] : metadata) {
+        put_string(out, key);
+        put_string(out, value);
+        offset += 2 * sizeof(uint32_t) + key.size() + value.size();
+    }
+    pad_to(out, offset, 8);
+
+    put(out, static_cast<uint64_t>(levels_.size()));
+    put(out, kColumns);
+    put(out, uint32_t{0});
+    offset += sizeof(uint64_t) + 2 * sizeof(uint32_t);
+
+    // Column data starts after the directory, each column 64-byte aligned
+    uint64_t data = offset + kColumns * kDirectoryEntry;
+    for (const Column& column : columns) {
+        data = (data + kColumnAlignment - 1) / kColumnAlignment *
+               kColumnAlignment;
+        put_fixed<16>(out, column.name);
+        put_fixed<8>(out, column.dtype);
+        put(out, data);
+        data += column.bytes;
+    }
+    offset += kColumns * kDirectoryEntry;
+
+    for (const Column& column : columns) {
+        pad_to(out, offset, kColumnAlignment);
+        out.write(static_cast<const char*>(column.data),
+                  static_cast<std::streamsize>(column.bytes));
+        offset += column.bytes;
+    }
+    return static_cast<bool>(out);
+}
+
+TeeResultsSink::TeeResultsSink(std::vector<std::unique_ptr<ResultsSink>> sinks)
+    : sinks_(std::move(sinks)) {}
+
+void TeeResultsSink::add(const ResultRow& row) {
+    for (auto& sink : sinks_) sink->add(row);
+}
+
+bool TeeResultsSink::finish(const RunMetadata& metadata) {
+    bool ok = true;
+    for (auto& sink : sinks_) ok = sink->finish(metadata) && ok;
+    return ok;
+}
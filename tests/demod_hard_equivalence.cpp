@@ -0,0 +1,222 @@
+/**
+ * @brief Checks that the PerAxis and Exhaustive hard-decision engines of
+ * DemodulatorQAM give identical bits for every supported order.
+ *
+ * For M = 4 to 4096 both engines decide the same samples: every
+ * constellation point, samples just either side of every decision
+ * boundary, samples exactly on a boundary, and uniformly random samples
+ * covering the grid and a margin outside it. Away from the boundaries the
+ * packed and one-bit-per-byte outputs must match bit for bit. Exactly on a
+ * boundary either neighbour is equally close, so there the check is that
+ * both decisions are at the same distance. PerAxis must also slice NaN to
+ * the lowest level and infinities to the outermost ones. Run under
+ * QAM_SIMD=scalar, avx2 and avx512 to cover every slicer.
+ *
+ * Usage: demod_hard_equivalence
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "qam_simulator/demodulator_qam.hpp"
+#include "qam_simulator/packed_bits.hpp"
+#include "qam_simulator/qam_traits.hpp"
+#include "qam_simulator/sample_buffer.hpp"
+#include "qam_simulator/simd.hpp"
+
+namespace {
+
+constexpr int kOrders[] = {4, 16, 64, 256, 1024, 4096};
+constexpr size_t kRandomSamples = 20000;
+/// @brief Offset from a boundary; a power of two, so samples stay exact
+constexpr float kNearBoundary = 1.0f / 1024;
+
+using Engine = DemodulatorQAM::HardDecision;
+
+/**
+ * @brief Samples to decide, as I/Q planes.
+ */
+struct Samples {
+    std::vector<float> re;
+    std::vector<float> im;
+
+    void add(float i, float q) {
+        re.push_back(i);
+        im.push_back(q);
+    }
+
+    ConstSampleView view() const { return {re.data(), im.data(), re.size()}; }
+};
+
+/// @brief Symbol indices of a packed hard-decision stream
+std::vector<int> indices(const PackedBits& bits, int bps) {
+    std::vector<int> out(bits.size() / bps);
+    for (size_t k = 0; k < out.size(); ++k) {
+        out[k] = static_cast<int>(bits.read(k * bps, bps));
+    }
+    return out;
+}
+
+/// @brief Squared distance of (re, im) to point @p index, in double
+double distance_sq(const DemodulatorQAM& demod, int index, float re,
+                   float im) {
+    const auto point = demod.getConstellation()[index];
+    const double dr = static_cast<double>(re) - point.first;
+    const double di = static_cast<double>(im) - point.second;
+    return dr * dr + di * di;
+}
+
+/**
+ * @brief Decide @p samples with both engines.
+ *
+ * @param ties True if the samples lie exactly on a boundary
+ * @return Number of mismatching symbols
+ */
+size_t compare(int levels, const Samples& samples, bool ties,
+               const char* what) {
+    const DemodulatorQAM per_axis(levels, Engine::PerAxis);
+    const DemodulatorQAM exhaustive(levels, Engine::Exhaustive);
+    const int bps = per_axis.getBitsPerSymbol();
+    const ConstSampleView view = samples.view();
+
+    PackedBits a;
+    PackedBits b;
+    per_axis.demodulate_hard(view, a);
+    exhaustive.demodulate_hard(view, b);
+    const std::vector<int> ia = indices(a, bps);
+    const std::vector<int> ib = indices(b, bps);
+    const std::vector<uint8_t> bytes_a = per_axis.demodulate_hard(view);
+    const std::vector<uint8_t> bytes_b = exhaustive.demodulate_hard(view);
+
+    size_t mismatches = 0;
+    for (size_t k = 0; k < view.size(); ++k) {
+        bool same = ia[k] == ib[k];
+        if (!same && ties) {
+            same = distance_sq(per_axis, ia[k], view.re[k], view.im[k]) ==
+                   distance_sq(per_axis, ib[k], view.re[k], view.im[k]);
+        }
+        for (int j = 0; j < bps && same && !ties; ++j) {
+            same = bytes_a[k * bps + j] == bytes_b[k * bps + j];
+        }
+        if (!same && mismatches++ < 5) {
+            std::cerr << "  M=" << levels << " " << what << ": sample ("
+                      << view.re[k] << ", " << view.im[k]
+                      << ") PerAxis " << ia[k] << " Exhaustive " << ib[k]
+                      << "\n";
+        }
+    }
+    return mismatches;
+}
+
+/// @brief Every constellation point, on the grid
+Samples grid_points(int levels) {
+    Samples s;
+    for (const auto& [re, im] : DemodulatorQAM(levels).getConstellation()) {
+        s.add(re, im);
+    }
+    return s;
+}
+
+/**
+ * @brief Samples at @p offset from every boundary between two levels of
+ * one axis, with the other axis on each of its levels.
+ */
+Samples boundaries(int levels, float offset) {
+    Samples s;
+    const int axis_levels = 1 << (qamBitsPerSymbol(levels) / 2);
+    const float low = static_cast<float>(1 - axis_levels);
+    for (int k = 0; k + 1 < axis_levels; ++k) {
+        // Axis values are the odd integers; boundaries the even ones between
+        const float edge = low + 2.0f * static_cast<float>(k) + 1.0f;
+        for (int other = 0; other < axis_levels; ++other) {
+            const float level = low + 2.0f * static_cast<float>(other);
+            s.add(edge + offset, level);
+            s.add(level, edge + offset);
+        }
+    }
+    return s;
+}
+
+/// @brief Uniform samples over the grid plus one level spacing outside it
+Samples random_samples(int levels, std::mt19937& rng) {
+    const auto reach =
+        static_cast<float>(1 << (qamBitsPerSymbol(levels) / 2));
+    std::uniform_real_distribution<float> u(-reach - 2.0f, reach + 2.0f);
+    Samples s;
+    for (size_t k = 0; k < kRandomSamples; ++k) s.add(u(rng), u(rng));
+    return s;
+}
+
+/**
+ * @brief Slice NaN and infinite samples with PerAxis and compare against
+ * Exhaustive on finite stand-ins outside the grid (NaN counts as below it).
+ *
+ * @return Number of mismatching symbols
+ */
+size_t non_finite(int levels) {
+    constexpr float kNaN = std::numeric_limits<float>::quiet_NaN();
+    constexpr float kInf = std::numeric_limits<float>::infinity();
+    const auto reach =
+        static_cast<float>(1 << (qamBitsPerSymbol(levels) / 2));
+    const float odd[] = {kNaN, -kInf, kInf, 1.0f};
+    const float finite[] = {-reach, -reach, reach, 1.0f};
+    Samples odd_samples;
+    Samples stand_ins;
+    // Long enough for the vector loops and a scalar tail
+    for (int k = 0; k < 37; ++k) {
+        const int a = k % 4;
+        const int b = (k / 4) % 4;
+        odd_samples.add(odd[a], odd[b]);
+        stand_ins.add(finite[a], finite[b]);
+    }
+    const DemodulatorQAM per_axis(levels, Engine::PerAxis);
+    const DemodulatorQAM exhaustive(levels, Engine::Exhaustive);
+    const int bps = per_axis.getBitsPerSymbol();
+    PackedBits a;
+    PackedBits b;
+    per_axis.demodulate_hard(odd_samples.view(), a);
+    exhaustive.demodulate_hard(stand_ins.view(), b);
+    const std::vector<int> ia = indices(a, bps);
+    const std::vector<int> ib = indices(b, bps);
+    size_t mismatches = 0;
+    for (size_t k = 0; k < ia.size(); ++k) {
+        if (ia[k] != ib[k] && mismatches++ < 5) {
+            std::cerr << "  M=" << levels << " non-finite: sample ("
+                      << odd_samples.re[k] << ", " << odd_samples.im[k]
+                      << ") PerAxis " << ia[k] << " expected " << ib[k]
+                      << "\n";
+        }
+    }
+    return mismatches;
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "SIMD: " << simd::isaName(simd::activeIsa()) << "\n";
+    std::mt19937 rng(1);
+    size_t failures = 0;
+    for (int levels : kOrders) {
+        size_t mismatches = 0;
+        mismatches += compare(levels, grid_points(levels), false, "grid");
+        mismatches += compare(levels, boundaries(levels, kNearBoundary),
+                              false, "above boundary");
+        mismatches += compare(levels, boundaries(levels, -kNearBoundary),
+                              false, "below boundary");
+        mismatches +=
+            compare(levels, boundaries(levels, 0.0f), true, "on boundary");
+        mismatches +=
+            compare(levels, random_samples(levels, rng), false, "random");
+        mismatches += non_finite(levels);
+        std::cout << "M=" << levels << ": "
+                  << (mismatches == 0 ? "ok" : "MISMATCH") << "\n";
+        failures += mismatches;
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}